@@ -27,6 +27,8 @@ CodeCompletionTestModel::CodeCompletionTestModel(KTextEditor::View *parent, cons
 // Fake a series of completions
 QVariant CodeCompletionTestModel::data(const QModelIndex &index, int role) const
 {
+    ++m_dataRequests[role];
+
     switch (role) {
     case Qt::DisplayRole:
         if (index.row() < rowCount() / 2) {
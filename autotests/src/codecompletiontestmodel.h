@@ -8,6 +8,7 @@
 #ifndef CODECOMPLETIONTEST_MODEL_H
 #define CODECOMPLETIONTEST_MODEL_H
 
+#include <QHash>
 #include <QStringList>
 #include <ktexteditor/codecompletionmodel.h>
 
@@ -28,9 +29,16 @@ public:
     void completionInvoked(KTextEditor::View *view, const KTextEditor::Range &range, InvocationType invocationType) override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
+    /// Number of data() calls for the role so far
+    int dataRequests(int role) const
+    {
+        return m_dataRequests.value(role);
+    }
+
 private:
     QString m_startText;
     bool m_autoStartText;
+    mutable QHash<int, int> m_dataRequests;
 };
 
 class AbbreviationCodeCompletionTestModel : public CodeCompletionTestModel
@@ -24,6 +24,9 @@
 #include <QStandardPaths>
 #include <QTest>
 
+#include <algorithm>
+#include <limits>
+
 QTEST_MAIN(CompletionTest)
 
 using namespace KTextEditor;
@@ -569,4 +572,83 @@ void CompletionTest::benchCompletionModel()
     }
 }
 
+void CompletionTest::testIncrementalFiltering()
+{
+    KateCompletionModel *model = m_view->completionWidget()->model();
+    CodeCompletionTestModel *testModel = new CodeCompletionTestModel(m_view, QStringLiteral("foo"));
+    testModel->setRowCount(10000);
+    model->setCompletionModel(testModel);
+
+    auto filter = [&](const QString &typed) {
+        model->setCurrentCompletion({{testModel, typed}});
+        return model->filteredItemCount();
+    };
+
+    // typing more only rechecks the items matching so far, same result as filtering all items
+    QCOMPARE(filter(QStringLiteral("f")), 10000u);
+    filter(QStringLiteral("fo"));
+    const uint narrowed = filter(QStringLiteral("fooa"));
+    QVERIFY(narrowed > 0 && narrowed < 10000);
+    QCOMPARE(filter(QStringLiteral("x")), 0u);
+    QCOMPARE(filter(QStringLiteral("fooa")), narrowed);
+
+    // many items are only partially sorted, the rest is sorted once accessed
+    QCOMPARE(filter(QStringLiteral("foo")), 10000u);
+    KateCompletionModel::Group *group = model->m_ungrouped;
+    QVERIFY(group->unsortedFrom < group->filtered.size());
+    QVERIFY(model->index(countItems(model) - 1, 0).isValid());
+    QCOMPARE(group->unsortedFrom, std::numeric_limits<size_t>::max());
+    QVERIFY(std::is_sorted(group->filtered.begin(), group->filtered.end(), [model](const auto &left, const auto &right) {
+        return left.lessThan(model, right);
+    }));
+}
+
+void CompletionTest::testCachedItemData()
+{
+    KateCompletionModel *model = m_view->completionWidget()->model();
+    CodeCompletionTestModel *testModel = new CodeCompletionTestModel(m_view, QStringLiteral("foo"));
+    testModel->setRowCount(1000);
+    model->setCompletionModel(testModel);
+
+    // best matches counts are fetched once, not on each keystroke
+    model->setCurrentCompletion({{testModel, QStringLiteral("foo")}});
+    const int bestMatchesRequests = testModel->dataRequests(CodeCompletionModel::BestMatchesCount);
+    QVERIFY(bestMatchesRequests > 0);
+    model->setCurrentCompletion({{testModel, QStringLiteral("foo")}});
+    QCOMPARE(testModel->dataRequests(CodeCompletionModel::BestMatchesCount), bestMatchesRequests);
+
+    // the text of a shown row is fetched once
+    const QModelIndex index = model->index(0, 1);
+    const int displayRequests = testModel->dataRequests(Qt::DisplayRole);
+    const QString text = model->data(index, Qt::DisplayRole).toString();
+    QVERIFY(text.contains(QStringLiteral("foo")));
+    QVERIFY(testModel->dataRequests(Qt::DisplayRole) > displayRequests);
+    const int fetchedDisplayRequests = testModel->dataRequests(Qt::DisplayRole);
+    QCOMPARE(model->data(index, Qt::DisplayRole).toString(), text);
+    QCOMPARE(testModel->dataRequests(Qt::DisplayRole), fetchedDisplayRequests);
+
+    // changed source data is fetched again
+    Q_EMIT testModel->dataChanged(testModel->index(0, 0), testModel->index(testModel->rowCount() - 1, 0));
+    QCOMPARE(model->data(index, Qt::DisplayRole).toString(), text);
+    QVERIFY(testModel->dataRequests(Qt::DisplayRole) > fetchedDisplayRequests);
+}
+
+void CompletionTest::benchCompletionModelFiltering()
+{
+    // a language server returning huge lists, filtered while typing
+    KateCompletionModel *model = m_view->completionWidget()->model();
+    CodeCompletionTestModel *testModel = new CodeCompletionTestModel(m_view, QStringLiteral("foo"));
+    testModel->setRowCount(100000);
+    model->setCompletionModel(testModel);
+
+    const QStringList typed = {QStringLiteral("f"), QStringLiteral("fo"), QStringLiteral("foo"), QStringLiteral("fooa")};
+    QBENCHMARK {
+        model->setCurrentCompletion({});
+        for (const QString &text : typed) {
+            model->setCurrentCompletion({{testModel, text}});
+        }
+    }
+    QVERIFY(model->filteredItemCount() > 0);
+}
+
 #include "moc_completion_test.cpp"
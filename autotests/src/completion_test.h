@@ -54,10 +54,13 @@ private Q_SLOTS:
     void testAbbreviationEngine();
     void testAutoCompletionPreselectFirst();
     void testTabCompletion();
+    void testIncrementalFiltering();
+    void testCachedItemData();
     void benchAbbreviationEngineNormalCase();
     void benchAbbreviationEngineWorstCase();
     void benchAbbreviationEngineGoodCase();
     void benchCompletionModel();
+    void benchCompletionModelFiltering();
 
 private:
     KTextEditor::Document *m_doc;
@@ -53,6 +53,27 @@ void IndentDetectTest::test()
     }
 }
 
+void IndentDetectTest::testLargeFileSampled()
+{
+    // a long tab indented header, the file itself uses two spaces
+    QStringList lines;
+    for (int i = 0; i < 12000; ++i) {
+        lines << QStringLiteral("header") << QStringLiteral("\tdetail");
+    }
+    for (int i = 0; i < 100000; ++i) {
+        lines << QStringLiteral("if (a) {") << QStringLiteral("  b();") << QStringLiteral("  if (c) {") << QStringLiteral("    d();")
+              << QStringLiteral("  }") << QStringLiteral("}");
+    }
+
+    DocumentPrivate doc;
+    doc.setText(lines);
+
+    KateIndentDetecter detecter(&doc);
+    const auto result = detecter.detect(4, false);
+    QVERIFY(result.indentUsingSpaces);
+    QCOMPARE(result.indentWidth, 2);
+}
+
 void IndentDetectTest::bench()
 {
     // kate document is fairly large, lets use it for benchmarking
@@ -14,6 +14,7 @@ class IndentDetectTest : public QObject
 private Q_SLOTS:
     void test_data();
     void test();
+    void testLargeFileSampled();
     void bench();
 };
 
@@ -16,6 +16,7 @@
 #include "kateconfig.h"
 #include "katedocument.h"
 
+#include <QElapsedTimer>
 #include <QTest>
 
 #include "testutils.h"
@@ -192,4 +193,49 @@ void IndentTest::testR()
     runTest(ExpectedFailures());
 }
 
+void IndentTest::benchIndentLines_data()
+{
+    QTest::addColumn<QString>("highlighting");
+    QTest::addColumn<QString>("indenter");
+    QTest::addColumn<QString>("code");
+
+    QTest::addRow("cstyle") << QStringLiteral("C++") << QStringLiteral("cstyle")
+                            << QStringLiteral("int f(int x)\n{\nif (x) {\n// comment {\nreturn g(x,\n1);\n}\nreturn 0;\n}\n\n");
+    QTest::addRow("python") << QStringLiteral("Python") << QStringLiteral("python")
+                            << QStringLiteral("def f(x):\nif x:\n# comment:\nreturn g(x,\n1)\nreturn 0\n\n");
+}
+
+void IndentTest::benchIndentLines()
+{
+    QFETCH(QString, highlighting);
+    QFETCH(QString, indenter);
+    QFETCH(QString, code);
+
+    const QString text = code.repeated(500);
+    m_document->setText(text);
+    m_document->setHighlightingMode(highlighting);
+    m_document->config()->setIndentationMode(indenter);
+
+    // indenting all lines at once gives the same result as indenting line by line
+    for (int line = 0; line < m_document->lines(); ++line) {
+        m_document->align(m_view, KTextEditor::Range(line, 0, line, 0));
+    }
+    const QString expected = m_document->text();
+    m_document->setText(text);
+    m_document->align(m_view, m_document->documentRange());
+    QCOMPARE(m_document->text(), expected);
+
+    // only the indenting is timed, not the resetting of the text, reported per line
+    constexpr int runs = 5;
+    qint64 nsecs = 0;
+    for (int run = 0; run < runs; ++run) {
+        m_document->setText(text);
+        QElapsedTimer timer;
+        timer.start();
+        m_document->align(m_view, m_document->documentRange());
+        nsecs += timer.nsecsElapsed();
+    }
+    QTest::setBenchmarkResult(qreal(nsecs) / (qreal(runs) * m_document->lines()), QTest::WalltimeNanoseconds);
+}
+
 #include "moc_indenttest.cpp"
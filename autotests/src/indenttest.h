@@ -56,6 +56,9 @@ private Q_SLOTS:
 
     void testR_data();
     void testR();
+
+    void benchIndentLines_data();
+    void benchIndentLines();
 };
 
 #endif // INDENTTEST_H
@@ -8,10 +8,13 @@
 #include "katedocument_test.h"
 #include "moc_katedocument_test.cpp"
 
+#include <katebuffer.h>
 #include <kateconfig.h>
 #include <katedocument.h>
 #include <kateview.h>
+#include <ktexteditor/documentcursor.h>
 
+#include <QFileInfo>
 #include <QRegularExpression>
 #include <QSignalSpy>
 #include <QStandardPaths>
@@ -238,6 +241,117 @@ void KateDocumentTest::testRemoveTextPerformance()
     }
 }
 
+void KateDocumentTest::testSaveFilePerformance()
+{
+    const int lines = 200000;
+    const int columns = 80;
+
+    KTextEditor::DocumentPrivate doc;
+
+    QString text;
+    const QString line = QString().fill(QLatin1Char('a'), columns);
+    for (int l = 0; l < lines; ++l) {
+        text.append(line);
+        text.append(QLatin1Char('\n'));
+    }
+
+    doc.setText(text);
+
+    QTemporaryFile file(QStringLiteral("testSaveFilePerformance"));
+    QVERIFY(file.open());
+
+    // save
+    QBENCHMARK {
+#ifdef USE_VALGRIND
+        CALLGRIND_START_INSTRUMENTATION
+#endif
+
+        QVERIFY(doc.buffer().saveFile(file.fileName()));
+
+#ifdef USE_VALGRIND
+        CALLGRIND_STOP_INSTRUMENTATION
+#endif
+    }
+
+    // all lines + line ends, the last line is empty
+    QCOMPARE(QFileInfo(file.fileName()).size(), qint64(text.size()));
+}
+
+void KateDocumentTest::testSaveDigestPerformance()
+{
+    const int lines = 200000;
+
+    KTextEditor::DocumentPrivate doc;
+
+    // some non-ASCII to have multi-byte UTF-8 sequences
+    QString text;
+    const QString line = QStringLiteral("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa äöü €€€ \U0001F600\n");
+    for (int l = 0; l < lines; ++l) {
+        text.append(line);
+    }
+
+    doc.setText(text);
+
+    QTemporaryFile file(QStringLiteral("testSaveDigestPerformance"));
+    QVERIFY(file.open());
+    QVERIFY(doc.saveAs(QUrl::fromLocalFile(file.fileName())));
+
+    // save, includes updating the digest
+    QBENCHMARK {
+        QVERIFY(doc.save());
+    }
+
+    // the digest computed while saving must match the one of the file on disk
+    const QByteArray savedDigest = doc.checksum();
+    QVERIFY(!savedDigest.isEmpty());
+    QVERIFY(doc.createDigest());
+    QCOMPARE(savedDigest, doc.checksum());
+
+    // after an edit only the changed block is measured again, the size in the digest header must follow
+    doc.insertText(KTextEditor::Cursor(lines / 2, 0), QStringLiteral("ß€"));
+    QVERIFY(doc.save());
+    const QByteArray editedDigest = doc.checksum();
+    QVERIFY(editedDigest != savedDigest);
+    QVERIFY(doc.createDigest());
+    QCOMPARE(editedDigest, doc.checksum());
+}
+
+void KateDocumentTest::testModOnHdCheckPerformance()
+{
+    const int lines = 200000;
+    const int columns = 80;
+
+    QTemporaryFile file(QStringLiteral("testModOnHdCheckPerformance"));
+    QVERIFY(file.open());
+    const QByteArray line = QByteArray(columns, 'a') + '\n';
+    for (int l = 0; l < lines; ++l) {
+        file.write(line);
+    }
+    file.flush();
+
+    // old enough to trust the modification time
+    QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(-3600), QFileDevice::FileModificationTime));
+
+    KTextEditor::DocumentPrivate doc;
+    QVERIFY(doc.openUrl(QUrl::fromLocalFile(file.fileName())));
+
+    // file only touched by dirwatch => unmodified
+    QBENCHMARK {
+        doc.m_modOnHd = true;
+        doc.m_modOnHdReason = KTextEditor::Document::OnDiskModified;
+        doc.slotDelayedHandleModOnHd();
+        QVERIFY(!doc.m_modOnHd);
+    }
+
+    // other size => modified
+    file.write("b\n");
+    file.flush();
+    doc.m_modOnHd = true;
+    doc.m_modOnHdReason = KTextEditor::Document::OnDiskModified;
+    doc.slotDelayedHandleModOnHd();
+    QVERIFY(doc.m_modOnHd);
+}
+
 void KateDocumentTest::testForgivingApiUsage()
 {
     KTextEditor::DocumentPrivate doc;
@@ -735,6 +849,98 @@ void KateDocumentTest::testMatchingBracket()
     QCOMPARE(doc.findMatchingBracket(cursor, maxLines), match);
 }
 
+/**
+ * Walk the document character by character, like findMatchingBracket() did before the bracket index.
+ */
+static KTextEditor::Range walkToMatchingBracket(KTextEditor::DocumentPrivate &doc, const KTextEditor::Cursor start, int maxLines)
+{
+    const QChar bracket = doc.characterAt(start);
+    const bool forward = bracket == QLatin1Char('{');
+    const QChar opposite = forward ? QLatin1Char('}') : QLatin1Char('{');
+    const int validAttr = doc.kateTextLine(start.line()).attribute(start.column());
+    const int minLine = qMax(start.line() - maxLines, 0);
+    const int maxLine = qMin(start.line() + maxLines, doc.lines() - 1);
+
+    int nesting = 0;
+    KTextEditor::DocumentCursor cursor(&doc, start);
+    while (cursor.move(forward ? 1 : -1) && cursor.line() >= minLine && cursor.line() <= maxLine) {
+        const Kate::TextLine textLine = doc.kateTextLine(cursor.line());
+        if (textLine.attribute(cursor.column()) != validAttr) {
+            continue;
+        }
+        const QChar c = textLine.at(cursor.column());
+        if (c == opposite) {
+            if (nesting == 0) {
+                return forward ? KTextEditor::Range(start, cursor.toCursor()) : KTextEditor::Range(cursor.toCursor(), start);
+            }
+            --nesting;
+        } else if (c == bracket) {
+            ++nesting;
+        }
+    }
+    return KTextEditor::Range::invalid();
+}
+
+void KateDocumentTest::testMatchingBracketAcrossBlocks()
+{
+    // nested functions spanning many buffer blocks, with brackets in strings and comments that don't count
+    QString text;
+    for (int i = 0; i < 20; ++i) {
+        text += QStringLiteral("void f%1() {\n").arg(i);
+        for (int j = 0; j < 30; ++j) {
+            text += QStringLiteral("    if (x) { y(\"}\"); } // {\n");
+            text += QStringLiteral("    while (z) {\n        /* } */ w();\n    }\n");
+        }
+        text += QStringLiteral("}\n");
+    }
+
+    KTextEditor::DocumentPrivate doc;
+    doc.setHighlightingMode(QStringLiteral("C++"));
+    doc.setText(text);
+
+    auto verify = [&doc](int maxLines) {
+        for (int line = 0; line < doc.lines(); line += 7) {
+            const QString lineText = doc.line(line);
+            for (int column = 0; column < lineText.size(); ++column) {
+                const KTextEditor::Cursor cursor(line, column);
+                if (lineText.at(column) == QLatin1Char('{') || lineText.at(column) == QLatin1Char('}')) {
+                    QCOMPARE(doc.findMatchingBracket(cursor, maxLines), walkToMatchingBracket(doc, cursor, maxLines));
+                }
+            }
+        }
+    };
+    verify(5000);
+    verify(50);
+
+    // the summaries of edited blocks must not be used any more
+    doc.insertText(KTextEditor::Cursor(300, 0), QStringLiteral("{\n{\n"));
+    doc.removeLine(900);
+    verify(5000);
+}
+
+void KateDocumentTest::benchMatchingBracket()
+{
+    // one large function, the match is far away from the opening bracket
+    QString text = QStringLiteral("int main() {\n");
+    for (int i = 0; i < 4000; ++i) {
+        text += QStringLiteral("    if (x) { y(); } else { z(); }\n");
+    }
+    text += QStringLiteral("}\n");
+
+    KTextEditor::DocumentPrivate doc;
+    doc.setHighlightingMode(QStringLiteral("C++"));
+    doc.setText(text);
+    doc.buffer().ensureHighlighted(doc.lines() - 1);
+
+    const KTextEditor::Range match({0, 11}, {4001, 0});
+    QCOMPARE(doc.findMatchingBracket(KTextEditor::Cursor(0, 11), 5000), match);
+
+    QBENCHMARK {
+        QCOMPARE(doc.findMatchingBracket(KTextEditor::Cursor(0, 11), 5000), match);
+        QCOMPARE(doc.findMatchingBracket(KTextEditor::Cursor(4001, 0), 5000), match);
+    }
+}
+
 void KateDocumentTest::testIndentOnPaste()
 {
     KTextEditor::DocumentPrivate doc;
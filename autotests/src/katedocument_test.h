@@ -77,6 +77,9 @@ private Q_SLOTS:
     void testMovingInterfaceSignals();
     void testSetTextPerformance();
     void testRemoveTextPerformance();
+    void testSaveFilePerformance();
+    void testSaveDigestPerformance();
+    void testModOnHdCheckPerformance();
     void testForgivingApiUsage();
     void testRemoveMultipleLines();
     void testInsertNewline();
@@ -92,6 +95,8 @@ private Q_SLOTS:
     void testSearch();
     void testMatchingBracket_data();
     void testMatchingBracket();
+    void testMatchingBracketAcrossBlocks();
+    void benchMatchingBracket();
     void testIndentOnPaste();
     void testAboutToSave();
     void testKeepUndoOverReload();
@@ -181,4 +181,260 @@ void KateFoldingTest::testUnfoldingInImportFoldingRanges()
     QCOMPARE(textFolding.debugDump(), QLatin1String("tree  - folded "));
 }
 
+// map lines by walking all lines, to verify the folded lines index
+static void verifyVisibleLineMapping(const Kate::TextFolding &folding, int lines)
+{
+    int visibleLine = -1;
+    for (int line = 0; line < lines; ++line) {
+        if (folding.isLineVisible(line)) {
+            ++visibleLine;
+            QCOMPARE(folding.visibleLineToLine(visibleLine), line);
+        }
+        QCOMPARE(folding.lineToVisibleLine(line), visibleLine);
+    }
+    QCOMPARE(folding.visibleLines(), visibleLine + 1);
+}
+
+void KateFoldingTest::testVisibleLineMappingAfterEdit()
+{
+    DocumentPrivate doc;
+    QStringList lines;
+    for (int i = 0; i < 100; ++i) {
+        lines << QStringLiteral("line %1").arg(i);
+    }
+    doc.setText(lines);
+
+    Kate::TextFolding folding(doc.buffer());
+    for (int i = 0; i < 10; ++i) {
+        folding.newFoldingRange(Range(i * 10, 0, i * 10 + 3, 2), Kate::TextFolding::Folded);
+    }
+    verifyVisibleLineMapping(folding, doc.lines());
+
+    // editing moves the folded ranges, the mapping must follow
+    doc.insertText(Cursor(21, 0), QStringLiteral("a\nb\nc\n"));
+    doc.removeLine(0);
+    verifyVisibleLineMapping(folding, doc.lines());
+
+    // a folded range containing folded ranges replaces them and gives them back on unfold
+    const qint64 outer = folding.newFoldingRange(Range(18, 0, 45, 0), Kate::TextFolding::Folded);
+    verifyVisibleLineMapping(folding, doc.lines());
+    folding.unfoldRange(outer);
+    verifyVisibleLineMapping(folding, doc.lines());
+
+    // folded ranges sharing their start after an edit, unfolding the second one must find it
+    folding.newFoldingRange(Range(90, 0, 91, 0), Kate::TextFolding::Folded);
+    const qint64 second = folding.newFoldingRange(Range(91, 0, 92, 0), Kate::TextFolding::Folded);
+    doc.removeText(Range(90, 0, 91, 0));
+    folding.unfoldRange(second);
+    QCOMPARE(folding.lineToVisibleLine(91) - folding.lineToVisibleLine(90), 1);
+    verifyVisibleLineMapping(folding, doc.lines());
+}
+
+void KateFoldingTest::benchVisibleLineMapping()
+{
+    // 100k folded ranges hiding one line each
+    const int folds = 100000;
+    DocumentPrivate doc;
+    doc.setText(QStringList(folds * 3, QStringLiteral("{")));
+
+    Kate::TextFolding folding(doc.buffer());
+    for (int i = 0; i < folds; ++i) {
+        folding.newFoldingRange(Range(i * 3, 1, i * 3 + 1, 1), Kate::TextFolding::Folded);
+    }
+    QCOMPARE(folding.visibleLines(), folds * 2);
+
+    QBENCHMARK {
+        // what scrolling through the whole document does
+        for (int visibleLine = 0; visibleLine < folds * 2; visibleLine += 7) {
+            const int line = folding.visibleLineToLine(visibleLine);
+            QCOMPARE(folding.lineToVisibleLine(line), visibleLine);
+        }
+    }
+}
+
+void KateFoldingTest::testComputeFoldingRanges_data()
+{
+    QTest::addColumn<QString>("mode");
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("C++") << QStringLiteral("C++")
+                         << QStringLiteral(
+                                "int f(bool one) {\n"
+                                "    if (one) {\n"
+                                "        return 1;\n"
+                                "    } else {\n"
+                                "        return 0;\n"
+                                "    }\n"
+                                "}\n"
+                                "/*\n"
+                                " * comment\n"
+                                " */\n"
+                                "int g() { return 1; }\n"
+                                "int h() {\n"
+                                "}\n"
+                                "struct S { int a;\n"
+                                "    int b; };\n"
+                                "int i() {\n"
+                                "    {\n"
+                                "        return 2;\n");
+    QTest::newRow("Python") << QStringLiteral("Python")
+                            << QStringLiteral(
+                                   "def f(one):\n"
+                                   "    if one:\n"
+                                   "        return 1\n"
+                                   "\n"
+                                   "    return 0\n"
+                                   "\n"
+                                   "\n"
+                                   "class C:\n"
+                                   "    def g(self):\n"
+                                   "        pass\n"
+                                   "x = 1\n"
+                                   "def h():\n"
+                                   "    return [\n"
+                                   "        1,\n"
+                                   "    ]\n");
+}
+
+void KateFoldingTest::testComputeFoldingRanges()
+{
+    QFETCH(QString, mode);
+    QFETCH(QString, text);
+
+    DocumentPrivate doc;
+    doc.setText(text);
+    doc.setHighlightingMode(mode);
+
+    // the single sweep must find the same ranges as asking each line
+    std::vector<std::pair<Range, bool>> expected;
+    for (int line = 0; line < doc.lines(); ++line) {
+        const Range range = doc.buffer().computeFoldingRangeForStartLine(line);
+        if (range.isValid()) {
+            expected.emplace_back(range, doc.buffer().isFoldingStartingOnLine(line).second);
+        }
+    }
+    QVERIFY(!expected.empty());
+    QCOMPARE(doc.buffer().computeFoldingRanges(), expected);
+}
+
+void KateFoldingTest::testFoldToplevelNodes()
+{
+    DocumentPrivate doc;
+    doc.setText(QStringLiteral(
+        "int f(bool one) {\n"
+        "    if (one) {\n"
+        "        return 1;\n"
+        "    } else {\n"
+        "        return 0;\n"
+        "    }\n"
+        "}\n"
+        "\n"
+        "int g() {\n"
+        "    return 123;\n"
+        "}\n"));
+    doc.setHighlightingMode(QStringLiteral("C++"));
+
+    const std::unique_ptr<ViewPrivate> view{static_cast<ViewPrivate *>(doc.createView(nullptr))};
+    auto &textFolding = view->textFolding();
+
+    // an already folded range stays as it is
+    textFolding.newFoldingRange(Range(1, 13, 3, 5), Kate::TextFolding::Folded | Kate::TextFolding::Persistent);
+
+    int changes = 0;
+    connect(&textFolding, &Kate::TextFolding::foldingRangesChanged, this, [&changes]() {
+        ++changes;
+    });
+
+    view->slotFoldToplevelNodes();
+    QCOMPARE(changes, 1);
+    QCOMPARE(textFolding.debugDump(), QLatin1String("tree [0:16 f [1:13 pf 3:5] 5:5] [8:8 f 9:15] - folded [0:16 f 5:5] [8:8 f 9:15]"));
+    QCOMPARE(textFolding.visibleLines(), 6);
+
+    // folding again changes nothing
+    view->slotFoldToplevelNodes();
+    QCOMPARE(textFolding.visibleLines(), 6);
+
+    // unfolding gives back the nested folded range
+    changes = 0;
+    view->slotExpandToplevelNodes();
+    QCOMPARE(changes, 1);
+    QCOMPARE(textFolding.debugDump(), QLatin1String("tree [1:13 pf 3:5] - folded [1:13 pf 3:5]"));
+    QCOMPARE(textFolding.visibleLines(), 10);
+}
+
+void KateFoldingTest::benchFoldToplevelNodes()
+{
+    // 10k functions with nested blocks
+    QStringList lines;
+    for (int i = 0; i < 10000; ++i) {
+        lines << QStringLiteral("int f%1(bool one) {").arg(i) << QStringLiteral("    if (one) {") << QStringLiteral("        return 1;")
+              << QStringLiteral("    }") << QStringLiteral("    return 0;") << QStringLiteral("}");
+    }
+    DocumentPrivate doc;
+    doc.setText(lines);
+    doc.setHighlightingMode(QStringLiteral("C++"));
+
+    const std::unique_ptr<ViewPrivate> view{static_cast<ViewPrivate *>(doc.createView(nullptr))};
+    QBENCHMARK {
+        view->slotFoldToplevelNodes();
+        QCOMPARE(view->textFolding().visibleLines(), 10000 * 2);
+        view->slotExpandToplevelNodes();
+    }
+}
+
+void KateFoldingTest::testFoldingCacheAfterEdit_data()
+{
+    testComputeFoldingRanges_data();
+}
+
+void KateFoldingTest::testFoldingCacheAfterEdit()
+{
+    QFETCH(QString, mode);
+    QFETCH(QString, text);
+
+    DocumentPrivate doc;
+    doc.setText(text);
+    doc.setHighlightingMode(mode);
+
+    // the cached results must match the ones of a fresh buffer
+    const auto verifyFoldings = [&doc, &mode]() {
+        DocumentPrivate fresh;
+        fresh.setText(doc.text());
+        fresh.setHighlightingMode(mode);
+        for (int line = 0; line < doc.lines(); ++line) {
+            QCOMPARE(doc.buffer().isFoldingStartingOnLine(line), fresh.buffer().isFoldingStartingOnLine(line));
+            QCOMPARE(doc.buffer().computeFoldingRangeForStartLine(line), fresh.buffer().computeFoldingRangeForStartLine(line));
+        }
+    };
+    verifyFoldings();
+
+    // edits in front of, inside and behind folding ranges
+    doc.insertText(Cursor(2, 0), QStringLiteral("    {\n"));
+    verifyFoldings();
+    doc.removeLine(0);
+    verifyFoldings();
+    doc.insertText(Cursor(doc.lines() - 1, 0), QStringLiteral("}\n\n"));
+    verifyFoldings();
+    doc.insertText(Cursor(4, 0), QStringLiteral("        "));
+    verifyFoldings();
+    doc.removeText(Range(1, 0, 5, 0));
+    verifyFoldings();
+}
+
+void KateFoldingTest::benchComputeFoldingRangeForStartLine()
+{
+    // one function spanning 100k lines
+    QStringList lines(100000, QStringLiteral("    call();"));
+    lines.front() = QStringLiteral("int f() {");
+    lines.back() = QStringLiteral("}");
+    DocumentPrivate doc;
+    doc.setText(lines);
+    doc.setHighlightingMode(QStringLiteral("C++"));
+
+    // what hovering the folding marker does
+    QBENCHMARK {
+        QCOMPARE(doc.buffer().computeFoldingRangeForStartLine(0), Range(0, 8, 99999, 1));
+    }
+}
+
 #include "moc_katefoldingtest.cpp"
@@ -23,6 +23,15 @@ private Q_SLOTS:
     void testBug295632();
     void testCrash367466();
     void testUnfoldingInImportFoldingRanges();
+    void testVisibleLineMappingAfterEdit();
+    void benchVisibleLineMapping();
+    void testComputeFoldingRanges_data();
+    void testComputeFoldingRanges();
+    void testFoldToplevelNodes();
+    void benchFoldToplevelNodes();
+    void testFoldingCacheAfterEdit_data();
+    void testFoldingCacheAfterEdit();
+    void benchComputeFoldingRangeForStartLine();
 };
 
 #endif // KATE_FOLDING_TEST_H
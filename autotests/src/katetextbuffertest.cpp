@@ -13,6 +13,7 @@
 #include <ktexteditor/movingcursor.h>
 
 #include <QStandardPaths>
+#include <QThread>
 
 QTEST_MAIN(KateTextBufferTest)
 
@@ -634,6 +635,70 @@ void KateTextBufferTest::testGetTextWithEmptyFirstBlock()
     QCOMPARE(doc.text().size(), 265);
 }
 
+void KateTextBufferTest::testSnapshot()
+{
+    KTextEditor::DocumentPrivate doc;
+    QStringList lines;
+    for (int i = 0; i < 1000; ++i) {
+        lines.append(QStringLiteral("line %1").arg(i));
+    }
+    const QString original = lines.join(u'\n');
+    doc.setText(original);
+
+    const Kate::TextSnapshot snapshot = doc.buffer().snapshot();
+    QCOMPARE(snapshot.lines(), 1000);
+    QCOMPARE(snapshot.revision(), doc.buffer().revision());
+    QCOMPARE(snapshot.lineText(0), QStringLiteral("line 0"));
+    QCOMPARE(snapshot.lineText(500), QStringLiteral("line 500"));
+    QCOMPARE(snapshot.lineText(999), QStringLiteral("line 999"));
+
+    // change text, split and merge blocks, the snapshot stays as it was
+    doc.insertText(KTextEditor::Cursor(500, 0), QStringLiteral("changed "));
+    doc.editStart();
+    for (int i = 0; i < 200; ++i) {
+        doc.insertLine(100, QStringLiteral("new"));
+    }
+    doc.editEnd();
+    doc.removeText(KTextEditor::Range(0, 0, 900, 0));
+    QVERIFY(doc.buffer().revision() != snapshot.revision());
+
+    QCOMPARE(snapshot.lines(), 1000);
+    QCOMPARE(snapshot.lineText(500), QStringLiteral("line 500"));
+    QCOMPARE(snapshot.text(), original);
+
+    // a new snapshot sees the changes
+    QCOMPARE(doc.buffer().snapshot().text(), doc.text());
+}
+
+void KateTextBufferTest::testSnapshotInThread()
+{
+    KTextEditor::DocumentPrivate doc;
+    QStringList lines;
+    for (int i = 0; i < 100000; ++i) {
+        lines.append(QStringLiteral("some text in line %1").arg(i));
+    }
+    doc.setText(lines.join(u'\n'));
+    const Kate::TextSnapshot snapshot = doc.buffer().snapshot();
+    const QString expected = doc.text();
+
+    // read the snapshot in a worker thread while we keep editing
+    QString read;
+    std::unique_ptr<QThread> worker(QThread::create([&snapshot, &read]() {
+        for (int round = 0; round < 10; ++round) {
+            read = snapshot.text();
+        }
+    }));
+    worker->start();
+    int i = 0;
+    while (!worker->isFinished()) {
+        doc.insertText(KTextEditor::Cursor((i * 37) % doc.lines(), 0), QStringLiteral("x"));
+        ++i;
+    }
+    worker->wait();
+
+    QCOMPARE(read, expected);
+}
+
 #if HAVE_KAUTH
 void KateTextBufferTest::saveFileWithElevatedPrivileges()
 {
@@ -33,6 +33,8 @@ private Q_SLOTS:
     void lineLengthLimit();
     void testBlockSplittingWithMovingRanges();
     void testGetTextWithEmptyFirstBlock();
+    void testSnapshot();
+    void testSnapshotInThread();
 
 #if HAVE_KAUTH
     void saveFileWithElevatedPrivileges();
@@ -11,7 +11,9 @@
 #include <katebuffer.h>
 #include <kateconfig.h>
 #include <katedocument.h>
+#include <katelayoutcache.h>
 #include <kateview.h>
+#include <kateviewhelpers.h>
 #include <kateviewinternal.h>
 #include <ktexteditor/message.h>
 #include <ktexteditor/movingcursor.h>
@@ -789,4 +791,201 @@ void KateViewTest::testCrashOnPasteInOverwriteMode()
     QCOMPARE(doc.text(), QStringLiteral("test1\ntest2\ntest1\ntest2\ntest3\n"));
 }
 
+/**
+ * Collects the regions painted in a widget
+ */
+class PaintRecorder : public QObject
+{
+public:
+    bool eventFilter(QObject *, QEvent *event) override
+    {
+        if (event->type() == QEvent::Paint) {
+            region += static_cast<QPaintEvent *>(event)->region();
+        }
+        return false;
+    }
+
+    QRegion region;
+};
+
+void KateViewTest::testCaretRepaint()
+{
+    KTextEditor::DocumentPrivate doc(false, false);
+    doc.setText(QStringLiteral("first line\nsecond line\nthird line\n") + QString(200, QLatin1Char('x')));
+
+    auto *view = static_cast<KTextEditor::ViewPrivate *>(doc.createView(nullptr));
+    view->config()->setDynWordWrap(true);
+    view->resize(400, 300);
+    view->show();
+    QVERIFY(QTest::qWaitForWindowExposed(view));
+    KateViewInternal *internal = view->getViewInternal();
+    view->setCursorPosition(Cursor(0, 3));
+    QTest::qWait(100);
+
+    // moving the caret keeps the layout of the old and the new line
+    KateLineLayout *first = internal->m_layoutCache->line(0);
+    KateLineLayout *second = internal->m_layoutCache->line(1);
+    KateLineLayout *wrapped = internal->m_layoutCache->line(3);
+    QVERIFY(!first->layoutDirty);
+    QVERIFY(!second->layoutDirty);
+    QVERIFY(!wrapped->layoutDirty);
+    QVERIFY(wrapped->layout().lineCount() > 1);
+    view->setCursorPosition(Cursor(0, 6));
+    QVERIFY(!first->layoutDirty);
+    view->setCursorPosition(Cursor(1, 2));
+    QVERIFY(!first->layoutDirty);
+    QVERIFY(!second->layoutDirty);
+    view->setCursorPosition(Cursor(3, 10));
+    view->setCursorPosition(Cursor(3, 150));
+    QVERIFY(!second->layoutDirty);
+    QVERIFY(!wrapped->layoutDirty);
+
+    // a blink only repaints the caret
+    auto blinkRegion = [&](const Cursor cursor) {
+        view->setCursorPosition(cursor);
+        QTest::qWait(100);
+        PaintRecorder recorder;
+        internal->installEventFilter(&recorder);
+        internal->paintCursor();
+        QTest::qWait(100);
+        internal->removeEventFilter(&recorder);
+        return recorder.region;
+    };
+
+    const Cursor inLine(1, 3);
+    QRegion region = blinkRegion(inLine);
+    QVERIFY(!region.isEmpty());
+    QVERIFY(internal->caretRect(inLine).contains(region.boundingRect()));
+    QVERIFY(region.boundingRect().width() < internal->width() / 2);
+
+    // at the line end the caret still gets a rect of its own, as wide as a space
+    const Cursor lineEnd(1, doc.lineLength(1));
+    const QRect lineEndRect = internal->caretRect(lineEnd);
+    QVERIFY(lineEndRect.contains(internal->mapFrom(view, view->cursorToCoordinate(lineEnd))));
+    QVERIFY(lineEndRect.width() > 2);
+    region = blinkRegion(lineEnd);
+    QVERIFY(!region.isEmpty());
+    QVERIFY(lineEndRect.contains(region.boundingRect()));
+
+    // in a wrapped line the caret is painted on its own view line
+    const Cursor inWrapped(3, 150);
+    const QRect wrappedRect = internal->caretRect(inWrapped);
+    QVERIFY(wrappedRect.top() > internal->caretRect(Cursor(3, 0)).top());
+    QVERIFY(wrappedRect.contains(internal->mapFrom(view, view->cursorToCoordinate(inWrapped))));
+    region = blinkRegion(inWrapped);
+    QVERIFY(!region.isEmpty());
+    QVERIFY(wrappedRect.contains(region.boundingRect()));
+}
+
+void KateViewTest::testMiniMapIncrementalUpdate()
+{
+    KTextEditor::DocumentPrivate doc(false, false);
+    QStringList lines;
+    for (int i = 0; i < 100; ++i) {
+        lines.append(QStringLiteral("line %1 with some text").arg(i));
+    }
+    doc.setText(lines);
+
+    auto *view = static_cast<KTextEditor::ViewPrivate *>(doc.createView(nullptr));
+    view->config()->setValue(KateViewConfig::ShowScrollBarMiniMap, true);
+    view->config()->setValue(KateViewConfig::ScrollPastEnd, false);
+    view->resize(400, 800);
+    view->show();
+    QVERIFY(QTest::qWaitForWindowExposed(view));
+
+    KateScrollBar *scrollBar = view->getViewInternal()->m_lineScroll;
+    QVERIFY(scrollBar->showMiniMap());
+    scrollBar->updatePixmap();
+    QVERIFY(!scrollBar->m_pixmap.isNull());
+
+    // few lines => one pixmap row per line, a marker at the end of a row shows if it is painted again
+    QCOMPARE(scrollBar->m_pixmapLayout.lineIncrement, 1);
+    QCOMPARE(scrollBar->m_pixmapLayout.charIncrement, 1);
+    const QPoint marker(scrollBar->m_pixmap.width() - 1, 90);
+    auto setMarker = [&]() {
+        QPainter painter(&scrollBar->m_pixmap);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(QRect(marker, QSize(1, 1)), Qt::magenta);
+    };
+    auto markerIntact = [&]() {
+        return scrollBar->m_pixmap.toImage().pixelColor(marker) == QColor(Qt::magenta);
+    };
+
+    // the incremental update must give the same pixmap as a rebuild from scratch
+    auto compareWithFullUpdate = [&]() {
+        QImage incremental = scrollBar->m_pixmap.toImage();
+        scrollBar->queuePixmapUpdate();
+        scrollBar->updatePixmap();
+        const QImage full = scrollBar->m_pixmap.toImage();
+        incremental.setPixelColor(marker, full.pixelColor(marker));
+        return incremental == full;
+    };
+
+    // editing a line only repaints its row
+    setMarker();
+    const QImage beforeEdit = scrollBar->m_pixmap.toImage();
+    doc.insertText(Cursor(10, 0), QStringLiteral("some more text "));
+    scrollBar->updatePixmap();
+    QVERIFY(markerIntact());
+    QVERIFY(scrollBar->m_pixmap.toImage().copy(0, 10, marker.x(), 1) != beforeEdit.copy(0, 10, marker.x(), 1));
+    QVERIFY(compareWithFullUpdate());
+
+    // selecting only repaints the selected rows
+    setMarker();
+    view->setSelection(Range(40, 0, 42, 3));
+    scrollBar->updatePixmap();
+    QVERIFY(markerIntact());
+    QVERIFY(compareWithFullUpdate());
+
+    // scrolling repaints nothing
+    setMarker();
+    view->setScrollPosition(Cursor(50, 0));
+    scrollBar->updatePixmap();
+    QVERIFY(markerIntact());
+
+    // folding changes the geometry, all rows are painted again
+    setMarker();
+    view->textFolding().newFoldingRange(Range(20, 0, 30, 0), Kate::TextFolding::Folded);
+    scrollBar->updatePixmap();
+    QVERIFY(!markerIntact());
+    QVERIFY(compareWithFullUpdate());
+
+    // edits below the folded range map to their visible rows
+    setMarker();
+    doc.insertText(Cursor(60, 0), QStringLiteral("some more text "));
+    scrollBar->updatePixmap();
+    QVERIFY(markerIntact());
+    QVERIFY(compareWithFullUpdate());
+}
+
+void KateViewTest::benchLongLinePainting()
+{
+    // one unwrapped line of 4 MB, painting should only look at the visible part of it
+    KTextEditor::DocumentPrivate doc(false, false);
+    QString text;
+    text.reserve(4 * 1024 * 1024 + 64);
+    while (text.size() < 4 * 1024 * 1024) {
+        text.append(QStringLiteral("lorem ipsum dolor sit amet "));
+    }
+    doc.setText(text);
+
+    auto *view = static_cast<KTextEditor::ViewPrivate *>(doc.createView(nullptr));
+    view->config()->setDynWordWrap(false);
+    view->resize(800, 400);
+    view->show();
+    const int middle = text.size() / 2;
+    view->setCursorPosition(Cursor(0, middle));
+    view->setSelection(Range(0, middle - 20, 0, middle + 20));
+
+    QWidget *internalView = findViewInternal(view);
+    QVERIFY(internalView);
+
+    // the first paint lays out the line
+    QImage image(internalView->size(), QImage::Format_ARGB32_Premultiplied);
+    internalView->render(&image);
+    QBENCHMARK {
+        internalView->render(&image);
+    }
+}
+
 // kate: indent-mode cstyle; indent-width 4; replace-tabs on;
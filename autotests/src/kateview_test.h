@@ -40,6 +40,9 @@ private Q_SLOTS:
     void testUpdateFoldingMarkersHighlighting();
     void testDdisplayRangeChangedEmitted();
     void testCrashOnPasteInOverwriteMode();
+    void testCaretRepaint();
+    void testMiniMapIncrementalUpdate();
+    void benchLongLinePainting();
 };
 
 #endif // KATE_VIEW_TEST_H
@@ -736,3 +736,99 @@ void ModificationSystemTest::testNavigation()
     QCOMPARE(doc.findTouchedLine(2, up), 2);
     QCOMPARE(doc.findTouchedLine(3, up), -1);
 }
+
+void ModificationSystemTest::testRepeatedSave()
+{
+    KTextEditor::DocumentPrivate doc;
+
+    const QString content(
+        QStringLiteral("0\n1\n2\n3\n4\n"
+                       "5\n6\n7\n8\n9"));
+    doc.setText(content);
+
+    // clear all modification flags, forces no flags
+    doc.setModified(false);
+    doc.undoManager()->updateLineModifications();
+    clearModificationFlags(&doc);
+
+    // one undo group per line
+    for (int i = 0; i < 10; ++i) {
+        doc.insertText(Cursor(i, 1), QStringLiteral("-"));
+        doc.undoManager()->undoSafePoint();
+    }
+
+    // save, touch line 5 again, save again
+    doc.setModified(false);
+    markModifiedLinesAsSaved(&doc);
+    doc.undoManager()->updateLineModifications();
+
+    doc.insertText(Cursor(5, 2), QStringLiteral("+"));
+    doc.undoManager()->undoSafePoint();
+
+    doc.setModified(false);
+    markModifiedLinesAsSaved(&doc);
+    doc.undoManager()->updateLineModifications();
+
+    // undo the last change of line 5
+    doc.undo();
+    QVERIFY(doc.isLineModified(5));
+    QVERIFY(!doc.isLineSaved(5));
+
+    // undo the change of line 9 from before both saves
+    doc.undo();
+    QVERIFY(doc.isLineModified(9));
+    QVERIFY(!doc.isLineSaved(9));
+
+    // redo both, back to the saved state
+    doc.redo();
+    QVERIFY(!doc.isLineModified(9));
+    QVERIFY(doc.isLineSaved(9));
+
+    doc.redo();
+    QVERIFY(!doc.isLineModified(5));
+    QVERIFY(doc.isLineSaved(5));
+
+    // undo, save with the redo stack, redo
+    doc.undo();
+    doc.setModified(false);
+    markModifiedLinesAsSaved(&doc);
+    doc.undoManager()->updateLineModifications();
+
+    doc.redo();
+    QVERIFY(doc.isLineModified(5));
+    QVERIFY(!doc.isLineSaved(5));
+
+    doc.undo();
+    QVERIFY(!doc.isLineModified(5));
+    QVERIFY(doc.isLineSaved(5));
+}
+
+void ModificationSystemTest::testLineModificationsPerformance()
+{
+    KTextEditor::DocumentPrivate doc;
+
+    QStringList lines;
+    for (int i = 0; i < 100000; ++i) {
+        lines.append(QStringLiteral("line"));
+    }
+    doc.setText(lines.join(u'\n'));
+
+    // deep undo history, each line changed in its own group
+    for (int i = 0; i < 20000; ++i) {
+        doc.insertText(Cursor(i * 5, 0), QStringLiteral("x"));
+        doc.undoManager()->undoSafePoint();
+    }
+    doc.setModified(false);
+    doc.undoManager()->updateLineModifications();
+
+    // saving after a single change only updates the flags around that change
+    int line = 0;
+    QBENCHMARK {
+        doc.insertText(Cursor(line, 0), QStringLiteral("y"));
+        doc.undoManager()->undoSafePoint();
+        line = (line + 7) % doc.lines();
+
+        doc.setModified(false);
+        doc.undoManager()->updateLineModifications();
+    }
+}
@@ -39,6 +39,9 @@ private Q_SLOTS:
     void testUnWrapLine2Empty();
 
     void testNavigation();
+
+    void testRepeatedSave();
+    void testLineModificationsPerformance();
 };
 
 #endif
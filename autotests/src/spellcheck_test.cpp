@@ -0,0 +1,155 @@
+/*
+    This file is part of the KDE libraries
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "spellcheck_test.h"
+
+#include <katedocument.h>
+#include <kateglobal.h>
+#include <kateview.h>
+#include <spellcheck/spellcheck.h>
+
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <sonnet/backgroundchecker.h>
+#include <sonnet/speller.h>
+
+QTEST_MAIN(SpellCheckTest)
+
+using namespace KTextEditor;
+
+SpellCheckTest::SpellCheckTest(QObject *parent)
+    : QObject(parent)
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+SpellCheckTest::~SpellCheckTest()
+{
+}
+
+void SpellCheckTest::testMisspellingsCache()
+{
+    KateSpellCheckManager *manager = EditorPrivate::self()->spellCheckManager();
+    const KateSpellCheckManager::Misspellings misspellings = {{QStringLiteral("wrold"), 6}};
+    manager->cacheMisspellings(QStringLiteral("hello wrold"), QStringLiteral("en_US"), misspellings);
+    manager->cacheMisspellings(QStringLiteral("hello"), QStringLiteral("en_US"), {});
+
+    const auto cached = manager->cachedMisspellings(QStringLiteral("hello wrold"), QStringLiteral("en_US"));
+    QVERIFY(cached);
+    QCOMPARE(*cached, misspellings);
+
+    // texts without misspellings are known, too
+    const auto cachedEmpty = manager->cachedMisspellings(QStringLiteral("hello"), QStringLiteral("en_US"));
+    QVERIFY(cachedEmpty);
+    QVERIFY(cachedEmpty->isEmpty());
+
+    // other texts and dictionaries are not
+    QVERIFY(!manager->cachedMisspellings(QStringLiteral("hello world"), QStringLiteral("en_US")));
+    QVERIFY(!manager->cachedMisspellings(QStringLiteral("hello wrold"), QStringLiteral("de_DE")));
+}
+
+void SpellCheckTest::testCacheInvalidation()
+{
+    KateSpellCheckManager *manager = EditorPrivate::self()->spellCheckManager();
+    const QString text = QStringLiteral("katecachetestword");
+    const KateSpellCheckManager::Misspellings misspellings = {{text, 0}};
+
+    // ignoring a word only drops the results of its dictionary
+    manager->cacheMisspellings(text, QStringLiteral("en_US"), misspellings);
+    manager->cacheMisspellings(text, QStringLiteral("de_DE"), misspellings);
+    quint64 generation = manager->dictionaryGeneration(QStringLiteral("en_US"));
+    const quint64 otherGeneration = manager->dictionaryGeneration(QStringLiteral("de_DE"));
+    manager->ignoreWord(text, QStringLiteral("en_US"));
+    QVERIFY(!manager->cachedMisspellings(text, QStringLiteral("en_US")));
+    QVERIFY(manager->cachedMisspellings(text, QStringLiteral("de_DE")));
+    QVERIFY(manager->dictionaryGeneration(QStringLiteral("en_US")) != generation);
+    QCOMPARE(manager->dictionaryGeneration(QStringLiteral("de_DE")), otherGeneration);
+
+    // same for words added to the dictionary
+    manager->cacheMisspellings(text, QStringLiteral("en_US"), misspellings);
+    generation = manager->dictionaryGeneration(QStringLiteral("en_US"));
+    manager->addToDictionary(text, QStringLiteral("en_US"));
+    QVERIFY(!manager->cachedMisspellings(text, QStringLiteral("en_US")));
+    QVERIFY(manager->cachedMisspellings(text, QStringLiteral("de_DE")));
+    QVERIFY(manager->dictionaryGeneration(QStringLiteral("en_US")) != generation);
+
+    // changed settings affect all dictionaries
+    manager->cacheMisspellings(text, QStringLiteral("en_US"), misspellings);
+    generation = manager->dictionaryGeneration(QStringLiteral("en_US"));
+    manager->settingsChanged();
+    QVERIFY(!manager->cachedMisspellings(text, QStringLiteral("en_US")));
+    QVERIFY(!manager->cachedMisspellings(text, QStringLiteral("de_DE")));
+    QVERIFY(manager->dictionaryGeneration(QStringLiteral("en_US")) != generation);
+    QVERIFY(manager->dictionaryGeneration(QStringLiteral("de_DE")) != otherGeneration);
+}
+
+void SpellCheckTest::testCachedOnTheFlyCheck()
+{
+    DocumentPrivate doc;
+    doc.setText(QStringLiteral("hello wrold\n\nfoo baar"));
+    auto *view = static_cast<ViewPrivate *>(doc.createView(nullptr));
+    view->resize(400, 300);
+    view->show();
+
+    // known texts are marked without asking Sonnet, empty lines don't stop the pass
+    KateSpellCheckManager *manager = EditorPrivate::self()->spellCheckManager();
+    const QString dictionary = doc.defaultDictionary();
+    manager->cacheMisspellings(QStringLiteral("hello wrold"), dictionary, {{QStringLiteral("wrold"), 6}});
+    manager->cacheMisspellings(QStringLiteral("foo baar"), dictionary, {{QStringLiteral("baar"), 4}});
+    doc.onTheFlySpellCheckingEnabled(true);
+
+    QTRY_COMPARE(doc.dictionaryForMisspelledRange(Range(0, 6, 0, 11)), dictionary);
+    QTRY_COMPARE(doc.dictionaryForMisspelledRange(Range(2, 4, 2, 8)), dictionary);
+    QVERIFY(doc.dictionaryForMisspelledRange(Range(0, 0, 0, 5)).isEmpty());
+    QVERIFY(!doc.findChild<Sonnet::BackgroundChecker *>());
+}
+
+void SpellCheckTest::testDictionaryChangeDuringCheck()
+{
+    if (Sonnet::Speller().availableDictionaries().isEmpty()) {
+        QSKIP("no Sonnet dictionaries installed");
+    }
+
+    // start without any cached results
+    KateSpellCheckManager *manager = EditorPrivate::self()->spellCheckManager();
+    manager->settingsChanged();
+
+    DocumentPrivate doc;
+    doc.setText(QStringLiteral("hello"));
+    auto *view = static_cast<ViewPrivate *>(doc.createView(nullptr));
+    view->resize(400, 300);
+    view->show();
+    doc.onTheFlySpellCheckingEnabled(true);
+
+    // the first check is done by Sonnet and cached
+    const QString dictionary = doc.defaultDictionary();
+    QTRY_VERIFY(manager->cachedMisspellings(QStringLiteral("hello"), dictionary));
+    auto *checker = doc.findChild<Sonnet::BackgroundChecker *>();
+    QVERIFY(checker);
+
+    // ignore some word while Sonnet still checks the next text, its result must not be cached
+    const QString text = QStringLiteral("xqzwv katecheckedword");
+    bool ignored = false;
+    connect(checker, &Sonnet::BackgroundChecker::misspelling, this, [&]() {
+        if (!ignored) {
+            ignored = true;
+            manager->ignoreWord(QStringLiteral("katecheckedword"), dictionary);
+        }
+    });
+    QSignalSpy done(checker, &Sonnet::BackgroundChecker::done);
+    doc.setText(text);
+    QTRY_VERIFY(done.count() > 0);
+    QVERIFY(ignored);
+    QVERIFY(!manager->cachedMisspellings(text, dictionary));
+
+    // checked again with the changed dictionary, that result is fine
+    done.clear();
+    doc.setText(text + QLatin1Char(' '));
+    QTRY_VERIFY(done.count() > 0);
+    QVERIFY(manager->cachedMisspellings(text, dictionary));
+}
@@ -0,0 +1,26 @@
+/*
+    This file is part of the KDE libraries
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef SPELLCHECK_TEST_H
+#define SPELLCHECK_TEST_H
+
+#include <QObject>
+
+class SpellCheckTest : public QObject
+{
+    Q_OBJECT
+public:
+    SpellCheckTest(QObject *parent = nullptr);
+    ~SpellCheckTest() override;
+
+private Q_SLOTS:
+    void testMisspellingsCache();
+    void testCacheInvalidation();
+    void testCachedOnTheFlyCheck();
+    void testDictionaryChangeDuringCheck();
+};
+
+#endif // SPELLCHECK_TEST_H
@@ -7,11 +7,14 @@
 #include "swapfiletest.h"
 
 #include <katedocument.h>
+#include <kateswapfile.h>
+#include <kateswapfilewriter.h>
 #include <kateundomanager.h>
 #include <kateview.h>
 
 #include <QFileInfo>
 #include <QProcess>
+#include <QRandomGenerator>
 #include <QTest>
 
 QTEST_MAIN(SwapFileTest)
@@ -29,6 +32,24 @@ QString SwapFileTest::createFile(const QByteArray &content)
     return QString();
 }
 
+QString SwapFileTest::recoverText(const QString &swapFileName, const QString &originalText)
+{
+    // the writer thread must be done with all pending writes
+    Kate::SwapFileWriter::self()->waitForIdle();
+
+    // replay the swap file on top of the original text, like the diff creator does
+    KTextEditor::DocumentPrivate recoverDoc;
+    recoverDoc.setText(originalText);
+
+    QFile swp(swapFileName);
+    if (!swp.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    QDataStream stream(&swp);
+    recoverDoc.swapFile()->recover(stream, false);
+    return recoverDoc.text();
+}
+
 void SwapFileTest::initTestCase()
 {
     // fresh clean dir per test
@@ -54,3 +75,218 @@ void SwapFileTest::testSwapFileIsCreatedAndDestroyed()
     delete doc;
     QTRY_VERIFY(!fi.absoluteDir().exists(swapFileName));
 }
+
+void SwapFileTest::testRecoverJournal()
+{
+    QVERIFY(m_testDir->isValid());
+    const QString original = QStringLiteral("first line\nsecond line\nthird line");
+    QString file = createFile(original.toUtf8());
+    KTextEditor::DocumentPrivate doc;
+    doc.openUrl(QUrl::fromLocalFile(file));
+
+    // mix of all recorded operations, including non-ASCII text and one transaction with many operations
+    doc.insertText({0, 5}, QStringLiteral(" äöü \U0001F600"));
+    doc.insertText({1, 0}, QStringLiteral("new\nlines\n"));
+    doc.removeText(KTextEditor::Range(3, 0, 3, 6));
+    doc.editStart();
+    for (int i = 0; i < 100; ++i) {
+        doc.insertText({0, 0}, QStringLiteral("x"));
+        doc.editWrapLine(0, 1);
+        doc.editUnWrapLine(0);
+    }
+    doc.editEnd();
+
+    // write all pending records
+    doc.swapFile()->commitJournal();
+
+    QCOMPARE(recoverText(doc.swapFile()->fileName(), original), doc.text());
+}
+
+void SwapFileTest::testCompactJournal()
+{
+    QVERIFY(m_testDir->isValid());
+    const QString original = QStringLiteral("some text");
+    QString file = createFile(original.toUtf8());
+    KTextEditor::DocumentPrivate doc;
+    doc.openUrl(QUrl::fromLocalFile(file));
+
+    // insert and remove large badly compressible text until the journal is compacted
+    QString text;
+    auto *random = QRandomGenerator::global();
+    for (int i = 0; i < 100000; ++i) {
+        text.append(QChar(u'!' + random->bounded(90)));
+    }
+    for (int i = 0; i < 150; ++i) {
+        doc.insertText({0, 0}, text);
+        doc.removeText(KTextEditor::Range(0, 0, 0, text.size()));
+        doc.swapFile()->commitJournal();
+    }
+    doc.insertText({0, 0}, QStringLiteral("last "));
+    doc.swapFile()->commitJournal();
+
+    // compacted => far smaller than all the text we did insert
+    Kate::SwapFileWriter::self()->waitForIdle();
+    QVERIFY(QFileInfo(doc.swapFile()->fileName()).size() < 8 * 1024 * 1024);
+    QCOMPARE(recoverText(doc.swapFile()->fileName(), original), doc.text());
+}
+
+void SwapFileTest::testCompactEmptyDocument()
+{
+    QVERIFY(m_testDir->isValid());
+    const QString original = QStringLiteral("some text\nmore text");
+    QString file = createFile(original.toUtf8());
+    KTextEditor::DocumentPrivate doc;
+    doc.openUrl(QUrl::fromLocalFile(file));
+
+    // select all + delete, the checkpoint contains no text at all
+    doc.removeText(doc.documentRange());
+    doc.swapFile()->commitJournal();
+    doc.swapFile()->compactJournal();
+
+    // the transactions after the checkpoint must be replayed too
+    doc.insertText({0, 0}, QStringLiteral("after\ncompaction"));
+    doc.swapFile()->commitJournal();
+
+    QCOMPARE(recoverText(doc.swapFile()->fileName(), original), doc.text());
+}
+
+void SwapFileTest::testRecoverVersion2()
+{
+    // swap file written before the journal format
+    QByteArray content;
+    QDataStream stream(&content, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_6);
+    stream << QByteArray("Kate Swap File 2.0") << QByteArray();
+    stream << qint8('S') << qint8('I') << 0 << 5 << QByteArray("ä ") << qint8('W') << 0 << 3 << qint8('E');
+    stream << qint8('S') << qint8('R') << 1 << 0 << 2 << qint8('U') << 1 << qint8('E');
+
+    KTextEditor::DocumentPrivate doc;
+    doc.setText(QStringLiteral("first line"));
+    QDataStream input(content);
+    input.setVersion(QDataStream::Qt_4_6);
+    QVERIFY(doc.swapFile()->recover(input, false));
+    QCOMPARE(doc.text(), QStringLiteral("firä  line"));
+}
+
+void SwapFileTest::testUnknownVersionIsKept()
+{
+    QVERIFY(m_testDir->isValid());
+    QString file = createFile("some text");
+    QFileInfo fi(file);
+    const QString swapFileName = fi.absoluteDir().absoluteFilePath(QStringLiteral(".%1.kate-swp").arg(fi.fileName()));
+
+    // e.g. written by a newer version
+    QFile swapFile(swapFileName);
+    QVERIFY(swapFile.open(QIODevice::WriteOnly));
+    QDataStream stream(&swapFile);
+    stream << QByteArray("Kate Swap File 99.0") << QByteArray() << qint8('X');
+    swapFile.close();
+
+    // never deleted, moved aside instead
+    KTextEditor::DocumentPrivate doc;
+    doc.openUrl(QUrl::fromLocalFile(file));
+    QVERIFY(QFile::exists(swapFileName + QStringLiteral(".unknown")));
+    QFile::remove(swapFileName + QStringLiteral(".unknown"));
+}
+
+void SwapFileTest::testRecoveryPerformance()
+{
+    QVERIFY(m_testDir->isValid());
+    QByteArray content;
+    for (int i = 0; i < 1000; ++i) {
+        content.append("this is some line of text in the original file\n");
+    }
+    const QString original = QString::fromUtf8(content);
+    QString file = createFile(content);
+    KTextEditor::DocumentPrivate doc;
+    doc.openUrl(QUrl::fromLocalFile(file));
+
+    // emulate typing, one transaction per character
+    for (int i = 0; i < 20000; ++i) {
+        const int line = i % 1000;
+        if (i % 50 == 49) {
+            doc.editStart();
+            doc.editWrapLine(line, 5);
+            doc.editUnWrapLine(line);
+            doc.editEnd();
+        } else {
+            doc.insertText({line, 0}, QStringLiteral("a"));
+        }
+    }
+    doc.swapFile()->commitJournal();
+
+    QString recovered;
+    QBENCHMARK {
+        recovered = recoverText(doc.swapFile()->fileName(), original);
+    }
+    QCOMPARE(recovered, doc.text());
+}
+
+void SwapFileTest::testRecoveryManyEditsPerformance()
+{
+    QVERIFY(m_testDir->isValid());
+    QByteArray content;
+    for (int i = 0; i < 1000; ++i) {
+        content.append("this is some line of text in the original file\n");
+    }
+    const QString original = QString::fromUtf8(content);
+    QString file = createFile(content);
+    KTextEditor::DocumentPrivate doc;
+    doc.openUrl(QUrl::fromLocalFile(file));
+
+    // 200000 recorded edits, e.g. a long session of replace all
+    for (int transaction = 0; transaction < 200; ++transaction) {
+        doc.editStart();
+        for (int i = 0; i < 1000; ++i) {
+            doc.insertText({i, 0}, QStringLiteral("ab"));
+            doc.removeText(KTextEditor::Range(i, 1, i, 2));
+        }
+        doc.editEnd();
+    }
+    doc.swapFile()->commitJournal();
+    Kate::SwapFileWriter::self()->waitForIdle();
+
+    QBENCHMARK {
+        KTextEditor::DocumentPrivate recoverDoc;
+        recoverDoc.setText(original);
+        const uint undoCount = recoverDoc.undoCount();
+        QFile swp(doc.swapFile()->fileName());
+        QVERIFY(swp.open(QIODevice::ReadOnly));
+        QDataStream stream(&swp);
+        QVERIFY(recoverDoc.swapFile()->recover(stream, false));
+
+        // replayed in bulk, no undo items
+        QCOMPARE(recoverDoc.text(), doc.text());
+        QCOMPARE(recoverDoc.undoCount(), undoCount);
+    }
+}
+
+void SwapFileTest::testSlowDevice()
+{
+    QVERIFY(m_testDir->isValid());
+    const QString original = QStringLiteral("some text");
+    QString file = createFile(original.toUtf8());
+    KTextEditor::DocumentPrivate doc;
+    doc.openUrl(QUrl::fromLocalFile(file));
+    doc.insertText({0, 0}, QStringLiteral("a"));
+    doc.swapFile()->commitJournal();
+    Kate::SwapFileWriter::self()->waitForIdle();
+    const qint64 size = QFileInfo(doc.swapFile()->fileName()).size();
+
+    // stall the writer like a hanging device, typing must not wait for it
+    QSemaphore device;
+    Kate::SwapFileWriter::self()->call([&device]() {
+        device.tryAcquire(1, 30000);
+    });
+    for (int i = 0; i < 10; ++i) {
+        doc.insertText({0, 0}, QStringLiteral("a"));
+        doc.swapFile()->commitJournal();
+        doc.swapFile()->writeFileToDisk();
+    }
+
+    // nothing written yet, all data arrives once the device is back
+    const qint64 stalledSize = QFileInfo(doc.swapFile()->fileName()).size();
+    device.release();
+    QCOMPARE(stalledSize, size);
+    QCOMPARE(recoverText(doc.swapFile()->fileName(), original), doc.text());
+}
@@ -22,9 +22,18 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void testSwapFileIsCreatedAndDestroyed();
+    void testRecoverJournal();
+    void testCompactJournal();
+    void testCompactEmptyDocument();
+    void testRecoverVersion2();
+    void testUnknownVersionIsKept();
+    void testRecoveryPerformance();
+    void testRecoveryManyEditsPerformance();
+    void testSlowDevice();
 
 private:
     QString createFile(const QByteArray &content);
+    static QString recoverText(const QString &swapFileName, const QString &originalText);
 
 private:
     std::unique_ptr<QTemporaryDir> m_testDir;
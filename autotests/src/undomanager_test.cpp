@@ -8,10 +8,12 @@
 
 #include "undomanager_test.h"
 
+#include <kateconfig.h>
 #include <katedocument.h>
 #include <kateundomanager.h>
 #include <kateview.h>
 
+#include <QSignalSpy>
 #include <QStandardPaths>
 #include <QTest>
 
@@ -278,4 +280,139 @@ void UndoManagerTest::testUndoAfterPastingWrappingLine()
     QCOMPARE(doc.text(), originalText);
 }
 
+void UndoManagerTest::testUndoMemoryUsage()
+{
+    KTextEditor::DocumentPrivate doc;
+    KateUndoManager *undoManager = doc.undoManager();
+    QCOMPARE(undoManager->memoryUsage(), qsizetype(0));
+
+    // ten thousand typed characters, a new undo group every 100 of them
+    for (int i = 0; i < 10000; ++i) {
+        doc.insertText(Cursor(0, i), QStringLiteral("x"));
+        if (i % 100 == 99) {
+            undoManager->undoSafePoint();
+        }
+    }
+    QCOMPARE(doc.undoCount(), 100u);
+
+    // the text is kept once per group, not once per item, stay well below 100 bytes per edit
+    const qsizetype usage = undoManager->memoryUsage();
+    QVERIFY(usage > 0);
+    QVERIFY(usage < 10000 * 100);
+
+    // the merged text is still correct, undo and redo move the usage between the stacks
+    doc.undo();
+    QCOMPARE(doc.text(), QString(9900, u'x'));
+    QCOMPARE(undoManager->memoryUsage(), usage);
+    doc.redo();
+    QCOMPARE(doc.text(), QString(10000, u'x'));
+    QCOMPARE(undoManager->memoryUsage(), usage);
+
+    // no history, no memory
+    undoManager->clearUndo();
+    undoManager->clearRedo();
+    QCOMPARE(undoManager->memoryUsage(), qsizetype(0));
+}
+
+void UndoManagerTest::testUndoMemoryLimit()
+{
+    KTextEditor::DocumentPrivate doc;
+    doc.config()->setValue(KateDocumentConfig::UndoMemoryLimit, 1);
+    KateUndoManager *undoManager = doc.undoManager();
+
+    // each group holds one line of 1000 characters
+    const QString line = QString(1000, u'a') + u'\n';
+    for (int i = 0; i < 2000; ++i) {
+        doc.insertText(Cursor(i, 0), line);
+        undoManager->undoSafePoint();
+        QVERIFY(undoManager->memoryUsage() <= 1024 * 1024);
+    }
+
+    // the oldest groups are gone
+    const uint count = doc.undoCount();
+    QVERIFY(count > 0u);
+    QVERIFY(count < 2000u);
+
+    // the remaining history still works
+    while (doc.undoCount() > 0) {
+        doc.undo();
+    }
+    QCOMPARE(doc.lines(), int(2000 - count + 1));
+    QVERIFY(doc.isModified());
+
+    // no limit
+    doc.config()->setValue(KateDocumentConfig::UndoMemoryLimit, 0);
+    for (int i = 0; i < 2000; ++i) {
+        doc.insertText(Cursor(0, 0), line);
+        undoManager->undoSafePoint();
+    }
+    QCOMPARE(doc.undoCount(), 2000u);
+}
+
+void UndoManagerTest::testUndoReplaceAllPerformance()
+{
+    KTextEditor::DocumentPrivate doc;
+
+    // 2000 lines with 50 matches each
+    QString line;
+    for (int i = 0; i < 50; ++i) {
+        line += QStringLiteral("foo bar ");
+    }
+    QStringList lines;
+    for (int i = 0; i < 2000; ++i) {
+        lines.append(line);
+    }
+    const QString original = lines.join(u'\n');
+    doc.setText(original);
+
+    // replace all, like the search bar does it: one transaction, one removal + insertion per match
+    doc.editStart();
+    for (int l = 0; l < doc.lines(); ++l) {
+        for (int c = 0; c < 50; ++c) {
+            doc.replaceText(Range(l, c * 8, l, c * 8 + 3), QStringLiteral("baz"));
+        }
+    }
+    doc.editEnd();
+    QCOMPARE(doc.undoCount(), 1u);
+    const QString replaced = doc.text();
+    QVERIFY(replaced != original);
+
+    QSignalSpy inserted(&doc, &KTextEditor::Document::textInsertedRange);
+    QSignalSpy removed(&doc, &KTextEditor::Document::textRemoved);
+
+    QBENCHMARK_ONCE {
+        doc.undo();
+        QCOMPARE(doc.text(), original);
+        doc.redo();
+        QCOMPARE(doc.text(), replaced);
+    }
+
+    // one removal and one insertion per line and direction, not per match
+    QVERIFY(inserted.count() <= 2 * 2000);
+    QVERIFY(removed.count() <= 2 * 2000);
+}
+
+void UndoManagerTest::benchUndoMemoryUsage()
+{
+    KTextEditor::DocumentPrivate doc;
+    KateUndoManager *undoManager = doc.undoManager();
+
+    // one million typed characters, a new undo group every 100 of them
+    QBENCHMARK_ONCE {
+        for (int i = 0; i < 1000000; ++i) {
+            doc.insertText(Cursor(i / 10000, i % 10000), QStringLiteral("x"));
+            if (i % 10000 == 9999) {
+                doc.insertText(Cursor(i / 10000, 10000), QStringLiteral("\n"));
+            }
+            if (i % 100 == 99) {
+                undoManager->undoSafePoint();
+            }
+        }
+    }
+
+    // the text is kept once per group, not once per item, stay well below 100 bytes per edit
+    QVERIFY(doc.undoCount() >= 10000u);
+    QVERIFY(undoManager->memoryUsage() < 16 * 1024 * 1024);
+}
+
 #include "moc_undomanager_test.cpp"
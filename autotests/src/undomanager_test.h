@@ -26,6 +26,10 @@ private Q_SLOTS:
     void testUndoWordWrapBug301367();
     void testUndoIndentBug373009();
     void testUndoAfterPastingWrappingLine();
+    void testUndoMemoryUsage();
+    void testUndoMemoryLimit();
+    void testUndoReplaceAllPerformance();
+    void benchUndoMemoryUsage();
 };
 
 #endif
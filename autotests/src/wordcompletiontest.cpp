@@ -7,7 +7,10 @@
 #include "wordcompletiontest.h"
 
 #include <katedocument.h>
+#include <kateglobal.h>
+#include <katesharedwordindex.h>
 #include <katewordcompletion.h>
+#include <katewordindex.h>
 #include <ktexteditor/editor.h>
 #include <ktexteditor/view.h>
 
@@ -102,4 +105,146 @@ void WordCompletionTest::benchWordRetrievalDistinct()
     }
 }
 
+void WordCompletionTest::benchWordRetrievalAfterEdit()
+{
+    // large document, completion after each keystroke only rescans the changed lines
+    QStringList s;
+    s.reserve(100 * count);
+    for (int i = 0; i < 100 * count; i++) {
+        s.append(QLatin1String("HelloWorld") + QString::number(i % count));
+    }
+    s.prepend(QStringLiteral("\n"));
+    m_doc->setText(s);
+
+    std::unique_ptr<KTextEditor::View> v(m_doc->createView(nullptr));
+    v->setCursorPosition(Cursor(1, 0));
+    KateWordCompletionModel m(nullptr);
+    QCOMPARE(m.allMatches(v.get(), KTextEditor::Range()).size(), count);
+
+    QBENCHMARK {
+        m_doc->insertText(Cursor(0, 0), QStringLiteral("xy"));
+        QCOMPARE(m.allMatches(v.get(), KTextEditor::Range()).size(), count + 1);
+        m_doc->removeText(Range(0, 0, 0, 2));
+    }
+}
+
+void WordCompletionTest::testWordIndexUpdates()
+{
+    m_doc->setText(QStringLiteral("\nfoo bar foo\nbaz_1 qux\nx"));
+    std::unique_ptr<KTextEditor::View> v(m_doc->createView(nullptr));
+    KateWordCompletionModel m(nullptr);
+
+    auto matches = [&]() {
+        QStringList result = m.allMatches(v.get(), KTextEditor::Range());
+        result.sort();
+        return result;
+    };
+
+    // single character words are not offered
+    QCOMPARE(matches(), (QStringList{QStringLiteral("bar"), QStringLiteral("baz_1"), QStringLiteral("foo"), QStringLiteral("qux")}));
+
+    auto *index = static_cast<KTextEditor::DocumentPrivate *>(m_doc)->wordIndex();
+    QCOMPARE(index->count(QStringLiteral("foo")), 2);
+
+    // remove one of the two foo, still there
+    m_doc->removeText(Range(1, 0, 1, 4));
+    QCOMPARE(matches(), (QStringList{QStringLiteral("bar"), QStringLiteral("baz_1"), QStringLiteral("foo"), QStringLiteral("qux")}));
+    QCOMPARE(index->count(QStringLiteral("foo")), 1);
+
+    // split a word by a line break, join lines again
+    m_doc->insertText(Cursor(2, 2), QStringLiteral("\n"));
+    QCOMPARE(matches(), (QStringList{QStringLiteral("ba"), QStringLiteral("bar"), QStringLiteral("foo"), QStringLiteral("qux"), QStringLiteral("z_1")}));
+    m_doc->removeText(Range(2, 2, 3, 0));
+    QCOMPARE(matches(), (QStringList{QStringLiteral("bar"), QStringLiteral("baz_1"), QStringLiteral("foo"), QStringLiteral("qux")}));
+
+    // the word we are typing is not offered, unless it is somewhere else, too
+    m_doc->insertText(Cursor(3, 1), QStringLiteral("yz"));
+    v->setCursorPosition(Cursor(3, 3));
+    QVERIFY(!m.allMatches(v.get(), Range(3, 0, 3, 3)).contains(QStringLiteral("xyz")));
+    m_doc->insertText(Cursor(0, 0), QStringLiteral("xyz"));
+    QVERIFY(m.allMatches(v.get(), Range(3, 0, 3, 3)).contains(QStringLiteral("xyz")));
+
+    // prefix queries
+    index->update();
+    QCOMPARE(index->wordsWithPrefix(QStringLiteral("ba"), 2), (QStringList{QStringLiteral("bar"), QStringLiteral("baz_1")}));
+    QCOMPARE(index->wordsWithPrefix(QStringLiteral("ba"), 4), (QStringList{QStringLiteral("baz_1")}));
+    QVERIFY(index->wordsWithPrefix(QStringLiteral("nothing"), 2).isEmpty());
+
+    // a typed word only gets the own words starting like it, in any case
+    m_doc->setText(QStringLiteral("foo Bar bar baz_1 qux\nba"));
+    v->setCursorPosition(Cursor(1, 2));
+    const QStringList typed = m.allMatches(v.get(), Range(1, 0, 1, 2));
+    QVERIFY(typed.contains(QStringLiteral("Bar")));
+    QVERIFY(typed.contains(QStringLiteral("bar")));
+    QVERIFY(typed.contains(QStringLiteral("baz_1")));
+    QVERIFY(!typed.contains(QStringLiteral("foo")));
+    QVERIFY(!typed.contains(QStringLiteral("qux")));
+
+    // and those with a later word part starting like it, like the completion widget matches them
+    m_doc->setText(QStringLiteral("BarFoo bar_foo barfoo _fooBar FOO_BAR\nFo"));
+    v->setCursorPosition(Cursor(1, 2));
+    const QStringList parts = m.allMatches(v.get(), Range(1, 0, 1, 2));
+    QVERIFY(parts.contains(QStringLiteral("BarFoo")));
+    QVERIFY(parts.contains(QStringLiteral("bar_foo")));
+    QVERIFY(parts.contains(QStringLiteral("_fooBar")));
+    QVERIFY(!parts.contains(QStringLiteral("barfoo")));
+    index->update();
+    QCOMPARE(index->wordsWithInitialOf(QStringLiteral("b"), 2),
+             (QStringList{QStringLiteral("BarFoo"), QStringLiteral("FOO_BAR"), QStringLiteral("_fooBar"), QStringLiteral("bar_foo"), QStringLiteral("barfoo")}));
+
+    // removed words are gone from the word parts, too
+    m_doc->setText(QStringLiteral("barfoo\nFo"));
+    index->update();
+    QCOMPARE(index->wordsWithInitialOf(QStringLiteral("f"), 2), (QStringList{QStringLiteral("Fo")}));
+
+    // clearing the document empties the index
+    m_doc->clear();
+    index->update();
+    QCOMPARE(index->size(), 0);
+}
+
+void WordCompletionTest::testSharedWordIndex()
+{
+    m_doc->setText(QStringLiteral("foo\nhe"));
+    std::unique_ptr<KTextEditor::View> v(m_doc->createView(nullptr));
+    v->setCursorPosition(Cursor(1, 2));
+    KateWordCompletionModel m(nullptr);
+
+    auto other = std::unique_ptr<KTextEditor::Document>(KTextEditor::Editor::instance()->createDocument(nullptr));
+    other->setText(QStringLiteral("helloWorld help\nfoo other _fooBar"));
+
+    // the other document indexes itself shortly after the change, completion only queries
+    auto *shared = KTextEditor::EditorPrivate::self()->sharedWordIndex();
+    QCOMPARE(shared->documentCount(QStringLiteral("help")), 0);
+    QTRY_COMPARE(shared->documentCount(QStringLiteral("help")), 1);
+
+    // words of other documents are offered for the typed prefix
+    QStringList result = m.allMatches(v.get(), Range(1, 0, 1, 2));
+    QVERIFY(result.contains(QStringLiteral("helloWorld")));
+    QVERIFY(result.contains(QStringLiteral("help")));
+    QVERIFY(!result.contains(QStringLiteral("other")));
+    QCOMPARE(result.count(QStringLiteral("foo")), 1);
+
+    QCOMPARE(shared->documentCount(QStringLiteral("foo")), 2);
+
+    // fuzzy matches
+    m_doc->setText(QStringLiteral("foo\nhW"));
+    QVERIFY(m.allMatches(v.get(), Range(1, 0, 1, 2)).contains(QStringLiteral("helloWorld")));
+    QCOMPARE(shared->fuzzyMatches(QStringLiteral("hW"), 3, 10), QStringList{QStringLiteral("helloWorld")});
+
+    // characters without case, like the underscore, are scanned, too
+    QCOMPARE(shared->fuzzyMatches(QStringLiteral("_fB"), 3, 10), QStringList{QStringLiteral("_fooBar")});
+
+    // edits of the other document are picked up
+    other->removeText(Range(0, 11, 0, 15));
+    QTRY_COMPARE(shared->documentCount(QStringLiteral("help")), 0);
+    QVERIFY(!m.allMatches(v.get(), Range(1, 0, 1, 2)).contains(QStringLiteral("help")));
+
+    // closing a document removes its words
+    other.reset();
+    QVERIFY(!m.allMatches(v.get(), Range(1, 0, 1, 2)).contains(QStringLiteral("helloWorld")));
+    QCOMPARE(shared->documentCount(QStringLiteral("foo")), 1);
+    QCOMPARE(shared->documentCount(QStringLiteral("helloWorld")), 0);
+}
+
 #include "moc_wordcompletiontest.cpp"
@@ -23,6 +23,10 @@ private Q_SLOTS:
     void benchWordRetrievalDistinct();
     void benchWordRetrievalSame();
     void benchWordRetrievalMixed();
+    void benchWordRetrievalAfterEdit();
+
+    void testWordIndexUpdates();
+    void testSharedWordIndex();
 
 private:
     KTextEditor::Document *m_doc;
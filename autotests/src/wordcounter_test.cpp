@@ -0,0 +1,175 @@
+/*
+    This file is part of the KDE libraries
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "wordcounter_test.h"
+
+#include <katedocument.h>
+#include <kateview.h>
+#include <wordcounter.h>
+
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTest>
+
+QTEST_MAIN(WordCounterTest)
+
+using namespace KTextEditor;
+
+struct Counts {
+    int wordsInDocument = 0;
+    int wordsInSelection = 0;
+    int charsInDocument = 0;
+    int charsInSelection = 0;
+};
+
+static Counts lastCounts(const QSignalSpy &spy)
+{
+    const QList<QVariant> args = spy.last();
+    return {args[0].toInt(), args[1].toInt(), args[2].toInt(), args[3].toInt()};
+}
+
+WordCounterTest::WordCounterTest(QObject *parent)
+    : QObject(parent)
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+WordCounterTest::~WordCounterTest()
+{
+}
+
+void WordCounterTest::testCountWords()
+{
+    QCOMPARE(WordCounter::countWords(u""), 0);
+    QCOMPARE(WordCounter::countWords(u"  "), 0);
+    QCOMPARE(WordCounter::countWords(u"foo"), 1);
+    QCOMPARE(WordCounter::countWords(u" foo bar1,baz "), 3);
+    QCOMPARE(WordCounter::countWords(u"a_b"), 2);
+    QCOMPARE(WordCounter::countWords(u"Grüße, 世界 x"), 3);
+}
+
+void WordCounterTest::testDocumentCounts()
+{
+    DocumentPrivate doc;
+    ViewPrivate view(&doc, nullptr);
+    WordCounter counter(&view);
+    QSignalSpy spy(&counter, &WordCounter::changed);
+
+    doc.setText(QStringLiteral("foo bar\nbaz\n\nqux quux corge"));
+    counter.updateNow();
+    QCOMPARE(lastCounts(spy).wordsInDocument, 6);
+    QCOMPARE(lastCounts(spy).charsInDocument, 24);
+
+    doc.insertText(Cursor(2, 0), QStringLiteral("one two"));
+    doc.removeText(Range(0, 0, 0, 4));
+    counter.updateNow();
+    QCOMPARE(lastCounts(spy).wordsInDocument, 7);
+    QCOMPARE(lastCounts(spy).charsInDocument, 27);
+
+    doc.clear();
+    counter.updateNow();
+    QCOMPARE(lastCounts(spy).wordsInDocument, 0);
+    QCOMPARE(lastCounts(spy).charsInDocument, 0);
+}
+
+void WordCounterTest::testSelectionCounts()
+{
+    DocumentPrivate doc;
+    ViewPrivate view(&doc, nullptr);
+    QStringList lines;
+    for (int i = 0; i < 1000; ++i) {
+        lines.append(QStringLiteral("word%1 and more").arg(i));
+    }
+    doc.setText(lines);
+
+    WordCounter counter(&view);
+    QSignalSpy spy(&counter, &WordCounter::changed);
+    counter.updateNow();
+    QCOMPARE(lastCounts(spy).wordsInDocument, 3000);
+
+    // over many blocks, from the middle of a line to the middle of another
+    view.setSelection(Range(10, 7, 900, 6));
+    QCOMPARE(lastCounts(spy).wordsInSelection, 2 + 889 * 3 + 1);
+    QCOMPARE(lastCounts(spy).charsInSelection, view.selectionText().size() - 890);
+
+    // the same with outdated counts
+    doc.insertText(Cursor(500, 0), QStringLiteral("new "));
+    view.clearSelection();
+    view.setSelection(Range(10, 7, 900, 6));
+    QCOMPARE(lastCounts(spy).wordsInSelection, 2 + 889 * 3 + 1 + 1);
+}
+
+void WordCounterTest::testLargeDocument()
+{
+    // the first count runs in a thread
+    DocumentPrivate doc;
+    ViewPrivate view(&doc, nullptr);
+    QStringList lines;
+    for (int i = 0; i < 200000; ++i) {
+        lines.append(QStringLiteral("some words here"));
+    }
+    doc.setText(lines);
+
+    WordCounter counter(&view);
+    QSignalSpy spy(&counter, &WordCounter::changed);
+    QTRY_VERIFY(!spy.isEmpty());
+    QCOMPARE(lastCounts(spy).wordsInDocument, 600000);
+
+    doc.insertText(Cursor(100000, 0), QStringLiteral("more "));
+    counter.updateNow();
+    QCOMPARE(lastCounts(spy).wordsInDocument, 600001);
+}
+
+void WordCounterTest::benchUpdateAfterEdit()
+{
+    DocumentPrivate doc;
+    ViewPrivate view(&doc, nullptr);
+    QStringList lines;
+    for (int i = 0; i < 1000000; ++i) {
+        lines.append(QStringLiteral("some words here"));
+    }
+    doc.setText(lines);
+
+    WordCounter counter(&view);
+    QSignalSpy spy(&counter, &WordCounter::changed);
+    counter.updateNow();
+
+    // only the edited block is counted again
+    QBENCHMARK {
+        doc.insertText(Cursor(500000, 0), QStringLiteral("x "));
+        counter.updateNow();
+        doc.removeText(Range(500000, 0, 500000, 2));
+        counter.updateNow();
+    }
+    QCOMPARE(lastCounts(spy).wordsInDocument, 3000000);
+}
+
+void WordCounterTest::benchSelectionAfterEdit()
+{
+    DocumentPrivate doc;
+    ViewPrivate view(&doc, nullptr);
+    QStringList lines;
+    for (int i = 0; i < 1000000; ++i) {
+        lines.append(QStringLiteral("some words here"));
+    }
+    doc.setText(lines);
+
+    WordCounter counter(&view);
+    QSignalSpy spy(&counter, &WordCounter::changed);
+    counter.updateNow();
+
+    // select all right after typing, before the counts are updated, only the edited block is counted
+    QBENCHMARK {
+        doc.insertText(Cursor(500000, 0), QStringLiteral("x "));
+        view.setSelection(doc.documentRange());
+        view.clearSelection();
+        doc.removeText(Range(500000, 0, 500000, 2));
+    }
+    view.setSelection(doc.documentRange());
+    QCOMPARE(lastCounts(spy).wordsInSelection, 3000000);
+}
+
+#include "moc_wordcounter_test.cpp"
@@ -0,0 +1,28 @@
+/*
+    This file is part of the KDE libraries
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef WORDCOUNTER_TEST_H
+#define WORDCOUNTER_TEST_H
+
+#include <QObject>
+
+class WordCounterTest : public QObject
+{
+    Q_OBJECT
+public:
+    WordCounterTest(QObject *parent = nullptr);
+    ~WordCounterTest() override;
+
+private Q_SLOTS:
+    void testCountWords();
+    void testDocumentCounts();
+    void testSelectionCounts();
+    void testLargeDocument();
+    void benchUpdateAfterEdit();
+    void benchSelectionAfterEdit();
+};
+
+#endif // WORDCOUNTER_TEST_H
@@ -36,20 +36,18 @@ int TextBlock::startLine() const
 TextLine TextBlock::line(int line) const
 {
     // right input
-    Q_ASSERT(size_t(line) < m_lines.size());
-    // get text line, at will bail out on out-of-range
-    return m_lines.at(line);
+    Q_ASSERT(line >= 0 && line < m_lines.size());
+    return m_lines[line];
 }
 
 void TextBlock::setLineMetaData(int line, const TextLine &textLine)
 {
     // right input
-    Q_ASSERT(size_t(line) < m_lines.size());
+    Q_ASSERT(line >= 0 && line < m_lines.size());
 
-    // set stuff, at will bail out on out-of-range
-    const QString originalText = m_lines.at(line).text();
-    m_lines.at(line) = textLine;
-    m_lines.at(line).text() = originalText;
+    const QString originalText = m_lines[line].text();
+    m_lines[line] = textLine;
+    m_lines[line].text() = originalText;
 }
 
 void TextBlock::appendLine(const QString &textOfLine)
@@ -77,7 +75,7 @@ void TextBlock::wrapLine(const KTextEditor::Cursor position, int fixStartLinesSt
     const int line = position.line() - startLine();
 
     // get text, copy, we might invalidate the reference
-    const QString text = m_lines.at(line).text();
+    const QString text = m_lines[line].text();
 
     // check if valid column
     Q_ASSERT(position.column() >= 0);
@@ -91,22 +89,22 @@ void TextBlock::wrapLine(const KTextEditor::Cursor position, int fixStartLinesSt
     // 1. line is wrapped in the middle
     // 2. if empty line is wrapped, mark new line as modified
     // 3. line-to-be-wrapped is already modified
-    if (position.column() > 0 || text.size() == 0 || m_lines.at(line).markedAsModified()) {
-        m_lines.at(line + 1).markAsModified(true);
-    } else if (m_lines.at(line).markedAsSavedOnDisk()) {
-        m_lines.at(line + 1).markAsSavedOnDisk(true);
+    if (position.column() > 0 || text.size() == 0 || m_lines[line].markedAsModified()) {
+        m_lines[line + 1].markAsModified(true);
+    } else if (m_lines[line].markedAsSavedOnDisk()) {
+        m_lines[line + 1].markAsSavedOnDisk(true);
     }
 
     // perhaps remove some text from previous line and append it
     if (position.column() < text.size()) {
         // text from old line moved first to new one
-        m_lines.at(line + 1).text() = text.right(text.size() - position.column());
+        m_lines[line + 1].text() = text.right(text.size() - position.column());
 
         // now remove wrapped text from old line
-        m_lines.at(line).text().chop(text.size() - position.column());
+        m_lines[line].text().chop(text.size() - position.column());
 
         // mark line as modified
-        m_lines.at(line).markAsModified(true);
+        m_lines[line].markAsModified(true);
     }
 
     // fix all start lines
@@ -184,7 +182,7 @@ void TextBlock::unwrapLine(int line, TextBlock *previousBlock, int fixStartLines
         Q_ASSERT(previousBlock->lines() > 0);
 
         // move last line of previous block to this one, might result in empty block
-        const TextLine oldFirst = m_lines.at(0);
+        const TextLine oldFirst = m_lines[0];
         const int lastLineOfPreviousBlock = previousBlock->lines() - 1;
         m_lines[0] = previousBlock->m_lines.back();
         previousBlock->m_lines.erase(previousBlock->m_lines.begin() + (previousBlock->lines() - 1));
@@ -280,17 +278,17 @@ void TextBlock::unwrapLine(int line, TextBlock *previousBlock, int fixStartLines
     m_buffer->m_blockSizes[m_blockIndex] -= 1;
 
     // easy: just move text to previous line and remove current one
-    const int oldSizeOfPreviousLine = m_lines.at(line - 1).length();
-    const int sizeOfCurrentLine = m_lines.at(line).length();
+    const int oldSizeOfPreviousLine = m_lines[line - 1].length();
+    const int sizeOfCurrentLine = m_lines[line].length();
     if (sizeOfCurrentLine > 0) {
-        m_lines.at(line - 1).text().append(m_lines.at(line).text());
+        m_lines[line - 1].text().append(m_lines[line].text());
     }
 
-    const bool lineChanged = (oldSizeOfPreviousLine > 0 && m_lines.at(line - 1).markedAsModified())
-        || (sizeOfCurrentLine > 0 && (oldSizeOfPreviousLine > 0 || m_lines.at(line).markedAsModified()));
-    m_lines.at(line - 1).markAsModified(lineChanged);
-    if (oldSizeOfPreviousLine == 0 && m_lines.at(line).markedAsSavedOnDisk()) {
-        m_lines.at(line - 1).markAsSavedOnDisk(true);
+    const bool lineChanged = (oldSizeOfPreviousLine > 0 && m_lines[line - 1].markedAsModified())
+        || (sizeOfCurrentLine > 0 && (oldSizeOfPreviousLine > 0 || m_lines[line].markedAsModified()));
+    m_lines[line - 1].markAsModified(lineChanged);
+    if (oldSizeOfPreviousLine == 0 && m_lines[line].markedAsSavedOnDisk()) {
+        m_lines[line - 1].markAsSavedOnDisk(true);
     }
 
     m_lines.erase(m_lines.begin() + line);
@@ -350,9 +348,9 @@ void TextBlock::insertText(const KTextEditor::Cursor position, const QString &te
     int line = position.line() - startLine();
 
     // get text
-    QString &textOfLine = m_lines.at(line).text();
+    QString &textOfLine = m_lines[line].text();
     int oldLength = textOfLine.size();
-    m_lines.at(line).markAsModified(true);
+    m_lines[line].markAsModified(true);
 
     // check if valid column
     Q_ASSERT(position.column() >= 0);
@@ -419,7 +417,7 @@ void TextBlock::removeText(KTextEditor::Range range, QString &removedText)
     int line = range.start().line() - startLine();
 
     // get text
-    QString &textOfLine = m_lines.at(line).text();
+    QString &textOfLine = m_lines[line].text();
     int oldLength = textOfLine.size();
 
     // check if valid column
@@ -433,7 +431,7 @@ void TextBlock::removeText(KTextEditor::Range range, QString &removedText)
 
     // remove text
     textOfLine.remove(range.start().column(), range.end().column() - range.start().column());
-    m_lines.at(line).markAsModified(true);
+    m_lines[line].markAsModified(true);
 
     // notify the text history
     m_buffer->history().removeText(range, oldLength);
@@ -485,12 +483,12 @@ void TextBlock::removeText(KTextEditor::Range range, QString &removedText)
 void TextBlock::debugPrint(int blockIndex) const
 {
     // print all blocks
-    for (size_t i = 0; i < m_lines.size(); ++i) {
+    for (qsizetype i = 0; i < m_lines.size(); ++i) {
         printf("%4d - %4llu : %4llu : '%s'\n",
                blockIndex,
                (unsigned long long)startLine() + i,
-               (unsigned long long)m_lines.at(i).text().size(),
-               qPrintable(m_lines.at(i).text()));
+               (unsigned long long)m_lines[i].text().size(),
+               qPrintable(m_lines[i].text()));
     }
 }
 
@@ -498,15 +496,15 @@ void TextBlock::splitBlock(int fromLine, TextBlock *newBlock)
 {
     Q_ASSERT(newBlock->m_cursors.empty());
     // move lines
-    auto myLinesToMoveBegin = m_lines.begin() + fromLine;
-    auto myLinesToMoveEnd = m_lines.end();
+    auto myLinesToMoveBegin = m_lines.cbegin() + fromLine;
+    auto myLinesToMoveEnd = m_lines.cend();
     int blockSizeChange = myLinesToMoveEnd - myLinesToMoveBegin;// how many newlines
     std::for_each(myLinesToMoveBegin, myLinesToMoveEnd, [&blockSizeChange] (const TextLine &line) -> void {
         blockSizeChange += line.length();// how many non-newlines
     });
     m_buffer->m_blockSizes[m_blockIndex] -= blockSizeChange;
     m_buffer->m_blockSizes[newBlock->m_blockIndex] += blockSizeChange;
-    newBlock->m_lines.insert(newBlock->m_lines.cend(), std::make_move_iterator(myLinesToMoveBegin), std::make_move_iterator(myLinesToMoveEnd));
+    newBlock->m_lines.append(m_lines.mid(fromLine));
     m_lines.resize(fromLine);
 
     // move cursors
@@ -560,7 +558,7 @@ void TextBlock::mergeBlock(TextBlock *targetBlock)
     std::inplace_merge(targetBlock->m_cursors.begin(), first_insertion_pos, targetBlock->m_cursors.end());
     Q_ASSERT(std::is_sorted(targetBlock->m_cursors.cbegin(), targetBlock->m_cursors.cend()));
     // move lines
-    targetBlock->m_lines.insert(targetBlock->m_lines.cend(), std::make_move_iterator(m_lines.begin()), std::make_move_iterator(m_lines.end()));
+    targetBlock->m_lines.append(std::move(m_lines));
     m_lines.clear();
 }
 
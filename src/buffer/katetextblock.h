@@ -209,9 +209,10 @@ private:
 
     /**
      * Lines contained in this buffer.
-     * We need no sharing, use STL.
+     * Implicitly shared with the TextSnapshot objects taken since the last change,
+     * the first change of the block after a snapshot detaches it.
      */
-    std::vector<Kate::TextLine> m_lines;
+    QList<Kate::TextLine> m_lines;
 
     /**
      * Set of cursors for this block.
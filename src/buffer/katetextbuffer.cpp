@@ -23,6 +23,8 @@
 #define CAN_USE_ERRNO
 #endif
 
+#include <optional>
+
 #include <QBuffer>
 #include <QCryptographicHash>
 #include <QFile>
@@ -282,6 +284,19 @@ QString TextBuffer::text() const
     return text;
 }
 
+TextSnapshot TextBuffer::snapshot() const
+{
+    TextSnapshot snapshot;
+    snapshot.m_blocks.reserve(m_blocks.size());
+    for (const TextBlock *block : m_blocks) {
+        snapshot.m_blocks.append(block->m_lines);
+    }
+    snapshot.m_startLines = m_startLines;
+    snapshot.m_lines = m_lines;
+    snapshot.m_revision = m_revision;
+    return snapshot;
+}
+
 bool TextBuffer::startEditing()
 {
     // increment transaction counter
@@ -836,6 +851,31 @@ bool TextBuffer::save(const QString &filename)
     return true;
 }
 
+/**
+ * Number of bytes the given text needs encoded as UTF-8.
+ * Lone surrogates are assumed to be replaced by U+FFFD.
+ */
+static qint64 utf8Length(QStringView text)
+{
+    qint64 length = text.size();
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        const char16_t c = text[i].unicode();
+        if (c < 0x80) {
+            continue;
+        }
+        if (c < 0x800) {
+            length += 1;
+        } else if (QChar::isHighSurrogate(c) && (i + 1) < text.size() && text[i + 1].isLowSurrogate()) {
+            // 4 bytes for the 2 code units
+            length += 2;
+            ++i;
+        } else {
+            length += 2;
+        }
+    }
+    return length;
+}
+
 bool TextBuffer::saveBuffer(const QString &filename, KCompressionDevice &saveFile)
 {
     QStringEncoder encoder(m_textCodec.toUtf8().constData(), generateByteOrderMark() ? QStringConverter::Flag::WriteBom : QStringConverter::Flag::Default);
@@ -848,21 +888,91 @@ bool TextBuffer::saveBuffer(const QString &filename, KCompressionDevice &saveFil
         eol = QStringLiteral("\r");
     }
 
-    // just dump the lines out ;)
-    for (int i = 0; i < m_lines; ++i) {
-        // dump current line
-        saveFile.write(encoder.encode(line(i).text()));
-
-        // append correct end of line string
-        if ((i + 1) < m_lines) {
-            saveFile.write(encoder.encode(eol));
+    // for uncompressed UTF-8 we know the size of the file upfront and can compute the
+    // git compatible digest while writing, no need to read the file again after saving
+    m_saveDigest.clear();
+    std::optional<QCryptographicHash> digest;
+    qint64 expectedBytes = -1;
+    if (saveFile.compressionType() == KCompressionDevice::None
+        && QStringConverter::encodingForName(m_textCodec.toUtf8().constData()) == QStringConverter::Utf8) {
+        expectedBytes = generateByteOrderMark() ? 3 : 0;
+
+        // only blocks changed since the last save are measured, the others still share their lines with the remembered snapshot
+        const TextSnapshot lines = snapshot();
+        QHash<const TextLine *, qint64> blockLengths;
+        blockLengths.reserve(lines.blocks().size());
+        for (const auto &block : lines.blocks()) {
+            qint64 length = m_utf8BlockLengths.value(block.constData(), -1);
+            if (length < 0) {
+                length = 0;
+                for (const TextLine &textLine : block) {
+                    length += utf8Length(textLine.text());
+                }
+            }
+            blockLengths.insert(block.constData(), length);
+            expectedBytes += length;
         }
+        m_utf8LengthSnapshot = lines;
+        m_utf8BlockLengths = std::move(blockLengths);
+        expectedBytes += qint64(m_lines - 1) * eol.size();
+
+        // init the hash with the git header
+        digest.emplace(QCryptographicHash::Sha1);
+        const QString header = QStringLiteral("blob %1").arg(expectedBytes);
+        digest->addData(QByteArray(header.toLatin1() + '\0'));
+    }
 
-        // early out on stream errors
-        if (saveFile.error() != QFileDevice::NoError) {
+    // encode the lines directly into one large reused buffer and write it out in big chunks,
+    // two small writes + temporary byte arrays per line make saving of large files really slow
+    QByteArray buffer(saveChunkLength, Qt::Uninitialized);
+    qsizetype used = 0;
+    qint64 writtenBytes = 0;
+    auto flush = [&saveFile, &buffer, &used, &digest, &writtenBytes]() {
+        if (used > 0 && saveFile.write(buffer.constData(), used) != used) {
             return false;
         }
+        if (digest) {
+            digest->addData(QByteArrayView(buffer.constData(), used));
+        }
+        writtenBytes += used;
+        used = 0;
+        return saveFile.error() == QFileDevice::NoError;
+    };
+
+    // just dump the lines out ;)
+    bool written = true;
+    int lineNumber = 0;
+    for (const TextBlock *block : m_blocks) {
+        // no TextLine copies, we only need the text
+        for (const TextLine &textLine : block->m_lines) {
+            const QString &text = textLine.text();
+            const bool appendEol = (++lineNumber) < m_lines;
+
+            // make room for the encoded line, worst case
+            const qsizetype needed = encoder.requiredSpace(text.size() + (appendEol ? eol.size() : 0));
+            if (used + needed > buffer.size()) {
+                // early out on stream errors
+                if (!flush()) {
+                    written = false;
+                    break;
+                }
+                if (needed > buffer.size()) {
+                    buffer.resize(needed);
+                }
+            }
+
+            // dump current line and append correct end of line string
+            char *end = encoder.appendToBuffer(buffer.data() + used, text);
+            if (appendEol) {
+                end = encoder.appendToBuffer(end, eol);
+            }
+            used = end - buffer.constData();
+        }
+        if (!written) {
+            break;
+        }
     }
+    written = written && flush();
 
     // TODO: this only writes bytes when there is text. This is a fine optimization for most cases, but this makes saving
     // an empty file with the BOM set impossible (results to an empty file with 0 bytes, no BOM)
@@ -871,11 +981,16 @@ bool TextBuffer::saveBuffer(const QString &filename, KCompressionDevice &saveFil
     saveFile.close();
 
     // did save work?
-    if (saveFile.error() != QFileDevice::NoError) {
+    if (!written || saveFile.error() != QFileDevice::NoError) {
         BUFFER_DEBUG << "Saving file " << filename << "failed with error" << saveFile.errorString();
         return false;
     }
 
+    // only trust the digest if our size guess was right, the header would be wrong otherwise
+    if (digest && writtenBytes == expectedBytes) {
+        m_saveDigest = digest->result();
+    }
+
     return true;
 }
 
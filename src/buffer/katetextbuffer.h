@@ -6,6 +6,7 @@
 #ifndef KATE_TEXTBUFFER_H
 #define KATE_TEXTBUFFER_H
 
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QSet>
@@ -13,6 +14,7 @@
 
 #include "katetextblock.h"
 #include "katetexthistory.h"
+#include "katetextsnapshot.h"
 #include <ktexteditor_export.h>
 
 // encoding prober
@@ -264,6 +266,13 @@ public:
      */
     QString text() const;
 
+    /**
+     * Take a copy-on-write snapshot of the buffer.
+     * This is cheap, no text is copied, the snapshot can be read from other threads.
+     * @return snapshot of the current text
+     */
+    TextSnapshot snapshot() const;
+
     /**
      * Start an editing transaction, the wrapLine/unwrapLine/insertText and removeText functions
      * are only allowed to be called inside a editing transaction.
@@ -538,8 +547,27 @@ public:
      */
     void setDigest(const QByteArray &checksum);
 
+    /**
+     * Git compatible sha1 digest of the data written by the last successful save(),
+     * computed while writing. Empty if it could not be computed on the fly, e.g. for
+     * compressed files or encodings other than UTF-8.
+     * @return digest of the last saved file or empty
+     */
+    const QByteArray &saveDigest() const
+    {
+        return m_saveDigest;
+    }
+
 private:
     QByteArray m_digest;
+    QByteArray m_saveDigest;
+
+    /**
+     * UTF-8 length of each block as of the last save, for the size in the header of the save digest.
+     * The snapshot keeps the measured blocks alive, a changed block gets a new line list.
+     */
+    TextSnapshot m_utf8LengthSnapshot;
+    QHash<const TextLine *, qint64> m_utf8BlockLengths;
 
 private:
     /**
@@ -652,6 +680,11 @@ private:
      * For copying QBuffer -> QTemporaryFile while saving document in privileged mode
      */
     static const qint64 bufferLength = 4096;
+
+    /**
+     * Size of the chunks the encoded text is written in on save
+     */
+    static const qint64 saveChunkLength = 1024 * 1024;
 };
 
 }
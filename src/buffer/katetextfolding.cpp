@@ -55,6 +55,9 @@ void TextFolding::clear()
 
 void TextFolding::clearFoldingRanges()
 {
+    // the buffer revision might restart, never trust the index from before
+    invalidateFoldedLinesIndex();
+
     // no ranges, no work
     if (m_foldingRanges.isEmpty()) {
         // assert all stuff is consistent and return!
@@ -116,6 +119,26 @@ qint64 TextFolding::newFoldingRange(KTextEditor::Range range, FoldingRangeFlags
     return newRange->id;
 }
 
+QList<qint64> TextFolding::newFoldingRanges(const QList<KTextEditor::Range> &ranges, FoldingRangeFlags flags)
+{
+    // create all ranges without notifications
+    QList<qint64> ids;
+    ids.reserve(ranges.size());
+    const bool blocked = blockSignals(true);
+    for (const KTextEditor::Range &range : ranges) {
+        ids.push_back(newFoldingRange(range, flags));
+    }
+    blockSignals(blocked);
+
+    // emit once that something may have changed
+    if (std::any_of(ids.cbegin(), ids.cend(), [](qint64 id) {
+            return id >= 0;
+        })) {
+        Q_EMIT foldingRangesChanged();
+    }
+    return ids;
+}
+
 KTextEditor::Range TextFolding::foldingRange(qint64 id) const
 {
     FoldingRange *range = m_idToFoldingRange.value(id);
@@ -212,6 +235,52 @@ bool TextFolding::unfoldRange(qint64 id, bool remove)
     return true;
 }
 
+void TextFolding::unfoldToplevelRanges()
+{
+    // rebuild the toplevel ranges in one pass, the nested ranges of removed ranges move up
+    FoldingRange::Vector newFoldingRanges;
+    newFoldingRanges.reserve(m_foldingRanges.size());
+    bool anyUpdate = false;
+    for (FoldingRange *range : std::as_const(m_foldingRanges)) {
+        // nothing to do for unfolded ranges
+        if (!(range->flags & Folded)) {
+            newFoldingRanges.push_back(range);
+            continue;
+        }
+
+        // unfold, keep the range if it is persistent
+        range->flags &= ~Folded;
+        anyUpdate = true;
+        if (range->flags & Persistent) {
+            newFoldingRanges.push_back(range);
+            continue;
+        }
+
+        // else remove it and reparent its nested ranges
+        for (FoldingRange *nestedRange : std::as_const(range->nestedRanges)) {
+            nestedRange->parent = nullptr;
+            newFoldingRanges.push_back(nestedRange);
+        }
+        m_idToFoldingRange.remove(range->id);
+        range->nestedRanges.clear();
+        delete range;
+    }
+
+    // nothing unfolded => be done
+    if (!anyUpdate) {
+        return;
+    }
+
+    // the nested folded ranges are now the topmost ones
+    m_foldingRanges = newFoldingRanges;
+    m_foldedFoldingRanges.clear();
+    appendFoldedRanges(m_foldedFoldingRanges, m_foldingRanges);
+    invalidateFoldedLinesIndex();
+
+    // folding changed!
+    Q_EMIT foldingRangesChanged();
+}
+
 bool TextFolding::isLineVisible(int line, qint64 *foldedRangeId) const
 {
     // skip if nothing folded
@@ -268,10 +337,8 @@ int TextFolding::visibleLines() const
         return visibleLines;
     }
 
-    // count all folded lines and subtract them from visible lines
-    for (FoldingRange *range : m_foldedFoldingRanges) {
-        visibleLines -= (range->end->line() - range->start->line());
-    }
+    // subtract all folded lines, the last index entry is the total
+    visibleLines -= foldedLinesIndex().back();
 
     // be done, assert we did no trash
     Q_ASSERT(visibleLines > 0);
@@ -283,37 +350,26 @@ int TextFolding::lineToVisibleLine(int line) const
     // valid input needed!
     Q_ASSERT(line >= 0);
 
-    // start with identity
-    int visibleLine = line;
-
     // skip if nothing folded or first line
     if (m_foldedFoldingRanges.isEmpty() || (line == 0)) {
-        return visibleLine;
+        return line;
     }
 
-    // walk over all folded ranges until we reach the line
-    // keep track of seen visible lines, for the case we want to convert a hidden line!
-    int seenVisibleLines = 0;
-    int lastLine = 0;
-    for (FoldingRange *range : m_foldedFoldingRanges) {
-        // abort if we reach our line!
-        if (range->start->line() >= line) {
-            break;
-        }
-
-        // count visible lines
-        seenVisibleLines += (range->start->line() - lastLine);
-        lastLine = range->end->line();
-
-        // we might be contained in the region, then we return last visible line
-        if (line <= range->end->line()) {
-            return seenVisibleLines;
-        }
+    // find the first folded range starting at or behind our line
+    const std::vector<int> &foldedLinesBefore = foldedLinesIndex();
+    const auto it = std::partition_point(m_foldedFoldingRanges.begin(), m_foldedFoldingRanges.end(), [line](FoldingRange *range) {
+        return range->start->line() < line;
+    });
+    const qsizetype index = it - m_foldedFoldingRanges.begin();
 
-        // subtrace folded lines
-        visibleLine -= (range->end->line() - range->start->line());
+    // we might be contained in the region in front of us, then we return its visible start line
+    if (index > 0 && line <= (*(it - 1))->end->line()) {
+        return (*(it - 1))->start->line() - foldedLinesBefore[index - 1];
     }
 
+    // else subtract all lines folded in front of us
+    const int visibleLine = line - foldedLinesBefore[index];
+
     // be done, assert we did no trash
     Q_ASSERT(visibleLine >= 0);
     return visibleLine;
@@ -324,42 +380,52 @@ int TextFolding::visibleLineToLine(int visibleLine) const
     // valid input needed!
     Q_ASSERT(visibleLine >= 0);
 
-    // start with identity
-    int line = visibleLine;
-
     // skip if nothing folded or first line
     if (m_foldedFoldingRanges.isEmpty() || (visibleLine == 0)) {
-        return line;
+        return visibleLine;
     }
 
-    // last visible line seen, as line in buffer
-    int seenVisibleLines = 0;
-    int lastLine = 0;
-    int lastLineVisibleLines = 0;
-    for (FoldingRange *range : m_foldedFoldingRanges) {
-        // else compute visible lines and move last seen
-        lastLineVisibleLines = seenVisibleLines;
-        seenVisibleLines += (range->start->line() - lastLine);
-
-        // bail out if enough seen
-        if (seenVisibleLines >= visibleLine) {
-            break;
+    // find the first folded range that starts at or behind our visible line
+    // the visible start lines of the folded ranges are sorted, too
+    const std::vector<int> &foldedLinesBefore = foldedLinesIndex();
+    qsizetype first = 0;
+    qsizetype count = m_foldedFoldingRanges.size();
+    while (count > 0) {
+        const qsizetype step = count / 2;
+        const qsizetype mid = first + step;
+        if (m_foldedFoldingRanges[mid]->start->line() - foldedLinesBefore[mid] < visibleLine) {
+            first = mid + 1;
+            count -= step + 1;
+        } else {
+            count = step;
         }
-
-        lastLine = range->end->line();
-    }
-
-    // check if still no enough visible!
-    if (seenVisibleLines < visibleLine) {
-        lastLineVisibleLines = seenVisibleLines;
     }
 
-    // compute visible line
-    line = (lastLine + (visibleLine - lastLineVisibleLines));
+    // add all lines folded in front of that range
+    const int line = visibleLine + foldedLinesBefore[first];
     Q_ASSERT(line >= 0);
     return line;
 }
 
+const std::vector<int> &TextFolding::foldedLinesIndex() const
+{
+    // still valid? editing moves the ranges, that changes the revision
+    if (m_foldedLinesRevision == m_buffer.revision() && m_foldedLinesBefore.size() == size_t(m_foldedFoldingRanges.size() + 1)) {
+        return m_foldedLinesBefore;
+    }
+
+    // recompute the prefix sums of the folded lines
+    m_foldedLinesBefore.resize(m_foldedFoldingRanges.size() + 1);
+    int foldedLines = 0;
+    for (qsizetype i = 0; i < m_foldedFoldingRanges.size(); ++i) {
+        m_foldedLinesBefore[i] = foldedLines;
+        foldedLines += m_foldedFoldingRanges[i]->end->line() - m_foldedFoldingRanges[i]->start->line();
+    }
+    m_foldedLinesBefore.back() = foldedLines;
+    m_foldedLinesRevision = m_buffer.revision();
+    return m_foldedLinesBefore;
+}
+
 QList<QPair<qint64, TextFolding::FoldingRangeFlags>> TextFolding::foldingRangesStartingOnLine(int line) const
 {
     // results vector
@@ -462,6 +528,11 @@ void TextFolding::editEnd(int startLine, int endLine, std::function<bool(int)> i
         anyUpdate = true;
     }
 
+    // folded ranges are gone, the index is outdated
+    if (anyUpdate) {
+        invalidateFoldedLinesIndex();
+    }
+
     // ensure we do the proper updates outside
     // we might change some range outside of the lines we edited
     if (anyUpdate) {
@@ -625,33 +696,17 @@ bool TextFolding::updateFoldedRangesForNewRange(TextFolding::FoldingRange *newRa
 
     // ok, if we arrive here, we are a folded range and we have no folded parent
     // we now want to add this range to the m_foldedFoldingRanges vector, just removing any ranges that is included in it!
-    // TODO: OPTIMIZE
-    FoldingRange::Vector newFoldedFoldingRanges;
-    bool newRangeInserted = false;
-    for (FoldingRange *range : std::as_const(m_foldedFoldingRanges)) {
-        // contained? kill
-        if ((newRange->start->toCursor() <= range->start->toCursor()) && (newRange->end->toCursor() >= range->end->toCursor())) {
-            continue;
-        }
-
-        // range is behind newRange?
-        // insert newRange if not already done
-        if (!newRangeInserted && (range->start->toCursor() >= newRange->end->toCursor())) {
-            newFoldedFoldingRanges.push_back(newRange);
-            newRangeInserted = true;
-        }
-
-        // just transfer range
-        newFoldedFoldingRanges.push_back(range);
-    }
-
-    // last: insert new range, if not done
-    if (!newRangeInserted) {
-        newFoldedFoldingRanges.push_back(newRange);
+    // the folded ranges are sorted and non-overlapping, the contained ones follow directly on the lower bound of our start
+    auto first = std::lower_bound(m_foldedFoldingRanges.begin(), m_foldedFoldingRanges.end(), newRange, compareRangeByStart);
+    auto last = first;
+    while (last != m_foldedFoldingRanges.end() && (*last)->end->toCursor() <= newRange->end->toCursor()) {
+        ++last;
     }
 
-    // fixup folded ranges
-    m_foldedFoldingRanges = newFoldedFoldingRanges;
+    // replace contained ranges with the new range
+    first = m_foldedFoldingRanges.erase(first, last);
+    m_foldedFoldingRanges.insert(first, newRange);
+    invalidateFoldedLinesIndex();
 
     // folding changed!
     Q_EMIT foldingRangesChanged();
@@ -681,22 +736,24 @@ bool TextFolding::updateFoldedRangesForRemovedRange(TextFolding::FoldingRange *o
 
     // ok, if we arrive here, we are a unfolded range and we have no folded parent
     // we now want to remove this range from the m_foldedFoldingRanges vector and include our nested folded ranges!
-    // TODO: OPTIMIZE
-    FoldingRange::Vector newFoldedFoldingRanges;
-    for (FoldingRange *range : std::as_const(m_foldedFoldingRanges)) {
-        // right range? insert folded nested ranges
-        if (range == oldRange) {
-            appendFoldedRanges(newFoldedFoldingRanges, oldRange->nestedRanges);
-            continue;
+    // several folded ranges may share the start, look through all of them, fall back to a linear search
+    auto it = std::lower_bound(m_foldedFoldingRanges.begin(), m_foldedFoldingRanges.end(), oldRange, compareRangeByStart);
+    while (it != m_foldedFoldingRanges.end() && *it != oldRange && !compareRangeByStart(oldRange, *it)) {
+        ++it;
+    }
+    if (it == m_foldedFoldingRanges.end() || *it != oldRange) {
+        it = std::find(m_foldedFoldingRanges.begin(), m_foldedFoldingRanges.end(), oldRange);
+    }
+    if (it != m_foldedFoldingRanges.end()) {
+        FoldingRange::Vector nestedFoldedRanges;
+        appendFoldedRanges(nestedFoldedRanges, oldRange->nestedRanges);
+        qsizetype index = m_foldedFoldingRanges.erase(it) - m_foldedFoldingRanges.begin();
+        for (FoldingRange *range : std::as_const(nestedFoldedRanges)) {
+            m_foldedFoldingRanges.insert(index++, range);
         }
-
-        // just transfer range
-        newFoldedFoldingRanges.push_back(range);
+        invalidateFoldedLinesIndex();
     }
 
-    // fixup folded ranges
-    m_foldedFoldingRanges = newFoldedFoldingRanges;
-
     // folding changed!
     Q_EMIT foldingRangesChanged();
 
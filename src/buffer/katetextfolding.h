@@ -17,6 +17,7 @@
 #include <QObject>
 
 #include <functional>
+#include <vector>
 
 namespace Kate
 {
@@ -70,6 +71,16 @@ public:
      */
     qint64 newFoldingRange(KTextEditor::Range range, FoldingRangeFlags flags = FoldingRangeFlags());
 
+    /**
+     * Create many new folding ranges at once.
+     * Like newFoldingRange() for each range, but foldingRangesChanged() is emitted only once.
+     * Fastest for ranges sorted by start, e.g. from KateBuffer::computeFoldingRanges().
+     * @param ranges folding ranges
+     * @param flags initial flags for all new folding ranges
+     * @return ids of the new ranges, -1 for each range that couldn't be created
+     */
+    QList<qint64> newFoldingRanges(const QList<KTextEditor::Range> &ranges, FoldingRangeFlags flags = FoldingRangeFlags());
+
     /**
      * Returns the folding range associated with @p id.
      * If @p id is not a valid id, the returned range matches KTextEditor::Range::invalid().
@@ -96,6 +107,12 @@ public:
      */
     bool unfoldRange(qint64 id, bool remove = false);
 
+    /**
+     * Unfold all folded toplevel ranges, nested folded ranges stay folded.
+     * Like unfoldRange() for each toplevel range, but in one pass and foldingRangesChanged() is emitted only once.
+     */
+    void unfoldToplevelRanges();
+
     /**
      * Query if a given line is visible.
      * Very fast, if nothing is folded, else does binary search
@@ -115,15 +132,15 @@ public:
 
     /**
      * Query number of visible lines.
-     * Very fast, if nothing is folded, else walks over all folded regions
-     * O(n) for n == number of folded ranges
+     * Very fast, if nothing is folded, else uses the folded lines index
+     * O(1) once the index is up-to-date
      */
     int visibleLines() const;
 
     /**
      * Convert a text buffer line to a visible line number.
-     * Very fast, if nothing is folded, else walks over all folded regions
-     * O(n) for n == number of folded ranges
+     * Very fast, if nothing is folded, else does binary search
+     * log(n) for n == number of folded ranges
      * @param line line index in the text buffer
      * @return index in visible lines
      */
@@ -131,8 +148,8 @@ public:
 
     /**
      * Convert a visible line number to a line number in the text buffer.
-     * Very fast, if nothing is folded, else walks over all folded regions
-     * O(n) for n == number of folded ranges
+     * Very fast, if nothing is folded, else does binary search
+     * log(n) for n == number of folded ranges
      * @param visibleLine visible line index
      * @return index in text buffer lines
      */
@@ -381,6 +398,34 @@ private:
      */
     FoldingRange::Vector m_foldedFoldingRanges;
 
+    /**
+     * Ensure m_foldedLinesBefore is up-to-date with the folded ranges and the buffer revision.
+     * O(n) for n == number of folded ranges if rebuilt, else O(1)
+     * @return number of hidden lines before each folded range, with the total as last element
+     */
+    KTEXTEDITOR_NO_EXPORT
+    const std::vector<int> &foldedLinesIndex() const;
+
+    /**
+     * Mark the folded lines index as outdated, must be called on each change of m_foldedFoldingRanges.
+     */
+    void invalidateFoldedLinesIndex()
+    {
+        m_foldedLinesRevision = -1;
+    }
+
+    /**
+     * prefix sums of hidden lines for m_foldedFoldingRanges
+     * entry i is the number of lines hidden by the folded ranges before range i
+     * editing moves the ranges, therefore this is only valid for m_foldedLinesRevision
+     */
+    mutable std::vector<int> m_foldedLinesBefore;
+
+    /**
+     * buffer revision m_foldedLinesBefore was computed for, -1 if invalid
+     */
+    mutable qint64 m_foldedLinesRevision = -1;
+
     /**
      * global id counter for the created ranges
      */
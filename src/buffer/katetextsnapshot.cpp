@@ -0,0 +1,35 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "katetextsnapshot.h"
+
+#include <algorithm>
+
+namespace Kate
+{
+TextLine TextSnapshot::line(int line) const
+{
+    // right input
+    Q_ASSERT(line >= 0 && line < m_lines);
+
+    // last block starting at or before the line
+    const auto it = std::upper_bound(m_startLines.begin(), m_startLines.end(), line);
+    const size_t block = (it - m_startLines.begin()) - 1;
+    return m_blocks[block][line - m_startLines[block]];
+}
+
+QString TextSnapshot::text() const
+{
+    QString text;
+    forEachLine([&text](int line, const QString &lineText) {
+        if (line > 0) {
+            text.append(QLatin1Char('\n'));
+        }
+        text.append(lineText);
+    });
+    return text;
+}
+}
@@ -0,0 +1,121 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_TEXTSNAPSHOT_H
+#define KATE_TEXTSNAPSHOT_H
+
+#include "katetextline.h"
+
+#include <QList>
+
+#include <ktexteditor_export.h>
+
+#include <vector>
+
+namespace Kate
+{
+/**
+ * Immutable copy of the text of a Kate::TextBuffer, see TextBuffer::snapshot().
+ *
+ * Taking a snapshot only copies one implicitly shared line list per block,
+ * the buffer detaches a block on its first change afterwards.
+ * Snapshots can be copied around and read from any thread, e.g. to index,
+ * search or export a document in a worker thread while the user keeps typing.
+ */
+class KTEXTEDITOR_EXPORT TextSnapshot
+{
+    friend class TextBuffer;
+
+public:
+    /**
+     * Construct an empty snapshot without any line.
+     */
+    TextSnapshot() = default;
+
+    /**
+     * Lines in this snapshot.
+     * @return number of lines
+     */
+    int lines() const
+    {
+        return m_lines;
+    }
+
+    /**
+     * Revision of the buffer this snapshot was taken at, -1 for an empty snapshot.
+     * @return buffer revision
+     */
+    qint64 revision() const
+    {
+        return m_revision;
+    }
+
+    /**
+     * Retrieve a text line.
+     * @param line wanted line number
+     * @return text line
+     */
+    TextLine line(int line) const;
+
+    /**
+     * Retrieve the text of a line.
+     * @param lineNumber wanted line number
+     * @return text of the line
+     */
+    QString lineText(int lineNumber) const
+    {
+        return line(lineNumber).text();
+    }
+
+    /**
+     * Retrieve the complete text.
+     * @return text of all lines, separated by '\n'
+     */
+    QString text() const;
+
+    /**
+     * Call @p func for each line with its line number and text, in order.
+     * Faster than calling line() for each line.
+     * @param func callable taking (int line, const QString &text)
+     */
+    template<typename Func>
+    void forEachLine(Func func) const
+    {
+        int line = 0;
+        for (const QList<TextLine> &block : m_blocks) {
+            for (const TextLine &textLine : block) {
+                func(line++, textLine.text());
+            }
+        }
+    }
+
+    /**
+     * Lines of all blocks.
+     * A block that did not change between two snapshots shares its lines with the older one,
+     * compare the constData() of the blocks to find the changed ones.
+     */
+    const QList<QList<TextLine>> &blocks() const
+    {
+        return m_blocks;
+    }
+
+private:
+    /**
+     * Lines of all blocks, shared with the blocks of the buffer until they change.
+     */
+    QList<QList<TextLine>> m_blocks;
+
+    /**
+     * Start line of each block.
+     */
+    std::vector<int> m_startLines;
+
+    int m_lines = 0;
+    qint64 m_revision = -1;
+};
+}
+
+#endif
@@ -20,9 +20,14 @@
 
 #include <QApplication>
 #include <QMultiMap>
+#include <QSemaphore>
+#include <QThreadPool>
 #include <QTimer>
 #include <QVarLengthArray>
 
+#include <atomic>
+#include <optional>
+
 using namespace KTextEditor;
 
 /// A helper-class for handling completion-models with hierarchical grouping/optimization
@@ -196,14 +201,31 @@ QVariant KateCompletionModel::data(const QModelIndex &index, int role) const
             }
         }
 
-        // Merge text for column merging
+        // Merge text for column merging, painting asks for it over and over
         if (role == Qt::DisplayRole) {
+            const size_t mergedColumn = index.column();
+            Group *g = groupOfParent(index) ? groupOfParent(index) : m_ungrouped;
+            std::optional<ModelRow> sourceRow;
+            if (mergedColumn < m_columnMerges.size() && size_t(index.row()) < g->filtered.size()) {
+                sourceRow = g->filtered[index.row()].sourceRow();
+                const auto it = m_rowData.constFind(*sourceRow);
+                if (it != m_rowData.cend() && it->hasDisplay[mergedColumn]) {
+                    return it->display[mergedColumn];
+                }
+            }
+
             QString text;
             for (int column : m_columnMerges[index.column()]) {
                 QModelIndex sourceIndex = mapToSource(createIndex(index.row(), column, index.internalPointer()));
                 text.append(sourceIndex.data(role).toString());
             }
 
+            // the source models might have changed while asked, look the row up again
+            if (sourceRow) {
+                RowData &cached = rowData(*sourceRow);
+                cached.display[mergedColumn] = text;
+                cached.hasDisplay[mergedColumn] = true;
+            }
             return text;
         }
 
@@ -278,6 +300,25 @@ QVariant KateCompletionModel::data(const QModelIndex &index, int role) const
     return QVariant();
 }
 
+KateCompletionModel::RowData &KateCompletionModel::rowData(const ModelRow &row) const
+{
+    return m_rowData[row];
+}
+
+int KateCompletionModel::bestMatchesCount(const ModelRow &row) const
+{
+    const auto it = m_rowData.constFind(row);
+    if (it != m_rowData.cend() && it->bestMatchesCount >= 0) {
+        return it->bestMatchesCount;
+    }
+
+    // ask the source model before touching the cache, it might change it meanwhile
+    const QVariant v = row.second.data(CodeCompletionModel::BestMatchesCount);
+    const int count = (v.userType() == QMetaType::Int && v.toInt() > 0) ? v.toInt() : 0;
+    rowData(row).bestMatchesCount = count;
+    return count;
+}
+
 int KateCompletionModel::contextMatchQuality(const QModelIndex &index) const
 {
     if (!index.isValid()) {
@@ -418,6 +459,10 @@ QModelIndex KateCompletionModel::index(int row, int column, const QModelIndex &p
             return QModelIndex();
         }
 
+        if (size_t(row) >= g->unsortedFrom) {
+            g->ensureSorted();
+        }
+
         // qCDebug(LOG_KTE) << "Returning index for child " << row << " of group " << g;
         return createIndex(row, column, g);
     }
@@ -464,6 +509,10 @@ QModelIndex KateCompletionModel::indexForRow(Group *g, int row) const
         return QModelIndex();
     }
 
+    if (size_t(row) >= g->unsortedFrom) {
+        g->ensureSorted();
+    }
+
     return createIndex(row, 0, g);
 }
 
@@ -483,6 +532,7 @@ QModelIndex KateCompletionModel::indexForGroup(Group *g) const
 
 void KateCompletionModel::clearGroups()
 {
+    m_rowData.clear();
     m_ungrouped->clear();
     m_argumentHints->clear();
     m_bestMatches->clear();
@@ -627,12 +677,9 @@ KateCompletionModel::Group *KateCompletionModel::createItem(const HierarchicalMo
         }
     }
 
+    // matches right away unless it is an argument hint
     Item item = Item(g != m_argumentHints, this, handler, ModelRow(handler.model(), sourceIndex));
 
-    if (g != m_argumentHints) {
-        item.match(this);
-    }
-
     g->addItem(item, notifyModel);
 
     return g;
@@ -640,6 +687,9 @@ KateCompletionModel::Group *KateCompletionModel::createItem(const HierarchicalMo
 
 void KateCompletionModel::slotRowsInserted(const QModelIndex &parent, int start, int end)
 {
+    // the rows moved, cached data is keyed by source index
+    m_rowData.clear();
+
     HierarchicalModelHandler handler(static_cast<CodeCompletionModel *>(sender()));
     if (parent.isValid()) {
         handler.collectRoles(parent);
@@ -657,6 +707,8 @@ void KateCompletionModel::slotRowsInserted(const QModelIndex &parent, int start,
 
 void KateCompletionModel::slotRowsRemoved(const QModelIndex &parent, int start, int end)
 {
+    m_rowData.clear();
+
     CodeCompletionModel *source = static_cast<CodeCompletionModel *>(sender());
 
     GroupSet affectedGroups;
@@ -854,19 +906,28 @@ void KateCompletionModel::setCurrentCompletion(QMap<KTextEditor::CodeCompletionM
 {
     beginResetModel();
 
+    // if the user just typed more, nothing that didn't match before can match now
+    changeTypes changeType = Narrow;
+    for (CodeCompletionModel *model : std::as_const(m_completionModels)) {
+        if (!currentMatch.value(model).startsWith(m_currentMatch.value(model))) {
+            changeType = Change;
+            break;
+        }
+    }
+
     m_currentMatch = currentMatch;
 
     if (!hasGroups()) {
-        changeCompletions(m_ungrouped);
+        changeCompletions(m_ungrouped, changeType);
     } else {
         for (Group *g : m_rowTable) {
             if (g != m_argumentHints) {
-                changeCompletions(g);
+                changeCompletions(g, changeType);
             }
         }
         for (Group *g : m_emptyGroups) {
             if (g != m_argumentHints) {
-                changeCompletions(g);
+                changeCompletions(g, changeType);
             }
         }
     }
@@ -937,18 +998,66 @@ QString KateCompletionModel::commonPrefix(QModelIndex selectedIndex) const
     return commonPrefix;
 }
 
-void KateCompletionModel::changeCompletions(Group *g)
+void KateCompletionModel::changeCompletions(Group *g, changeTypes changeType)
 {
     // This code determines what of the filtered items still fit
     // don't notify the model. The model is notified afterwards through a reset().
+    // When narrowing, the items filtered out before stay filtered out, only the visible ones are checked.
+    std::vector<Item> candidates;
+    if (changeType == Narrow) {
+        candidates.swap(g->filtered);
+    }
+    std::vector<Item> &items = (changeType == Narrow) ? candidates : g->prefilter;
+
+    std::vector<char> matched;
+    matchItems(items, matched);
+
     g->filtered.clear();
-    std::remove_copy_if(g->prefilter.begin(), g->prefilter.end(), std::back_inserter(g->filtered), [this](Item &item) {
-        return !item.match(this);
-    });
+    g->unsortedFrom = std::numeric_limits<size_t>::max();
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (matched[i]) {
+            g->filtered.push_back(items[i]);
+        }
+    }
 
     hideOrShowGroup(g, /*notifyModel=*/false);
 }
 
+void KateCompletionModel::matchItems(std::vector<Item> &items, std::vector<char> &matched)
+{
+    matched.assign(items.size(), 0);
+
+    // matching only reads the current completion and writes the item itself, chunks can run in parallel
+    const size_t chunkSize = 4096;
+    const size_t chunkCount = (items.size() + chunkSize - 1) / chunkSize;
+    std::atomic<size_t> nextChunk = 0;
+    auto matchChunks = [&] {
+        for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++) {
+            const size_t end = std::min(items.size(), (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; ++i) {
+                matched[i] = items[i].match(this) != Item::NoMatch;
+            }
+        }
+    };
+
+    // the GUI thread takes part, helpers steal the remaining chunks
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int helpers = std::min<int>(int(chunkCount) - 1, pool->maxThreadCount());
+    QSemaphore done;
+    int started = 0;
+    for (int i = 0; i < helpers; ++i) {
+        if (!pool->tryStart([&] {
+                matchChunks();
+                done.release();
+            })) {
+            break;
+        }
+        ++started;
+    }
+    matchChunks();
+    done.acquire(started);
+}
+
 int KateCompletionModel::Group::orderNumber() const
 {
     if (this == model->m_ungrouped) {
@@ -1244,6 +1353,7 @@ void KateCompletionModel::Group::addItem(const Item &i, bool notifyModel)
 
     if (i.isVisible()) {
         if (notifyModel) {
+            ensureSorted();
             auto comp = [this](const Item &left, const Item &right) {
                 return left.lessThan(model, right);
             };
@@ -1302,10 +1412,34 @@ void KateCompletionModel::Group::resort()
     auto comp = [this](const Item &left, const Item &right) {
         return left.lessThan(model, right);
     };
-    std::stable_sort(filtered.begin(), filtered.end(), comp);
+
+    // only a few rows are visible, for many items just bring the first ones in order,
+    // that are more than updateBestMatches() looks at without grouping
+    const size_t sortedRows = 1000;
+    if (filtered.size() > 4 * sortedRows) {
+        std::partial_sort(filtered.begin(), filtered.begin() + sortedRows, filtered.end(), comp);
+        unsortedFrom = sortedRows;
+    } else {
+        std::stable_sort(filtered.begin(), filtered.end(), comp);
+        unsortedFrom = std::numeric_limits<size_t>::max();
+    }
     model->hideOrShowGroup(this);
 }
 
+void KateCompletionModel::Group::ensureSorted()
+{
+    if (unsortedFrom >= filtered.size()) {
+        unsortedFrom = std::numeric_limits<size_t>::max();
+        return;
+    }
+
+    auto comp = [this](const Item &left, const Item &right) {
+        return left.lessThan(model, right);
+    };
+    std::stable_sort(filtered.begin() + unsortedFrom, filtered.end(), comp);
+    unsortedFrom = std::numeric_limits<size_t>::max();
+}
+
 void KateCompletionModel::resort()
 {
     for (Group *g : m_rowTable) {
@@ -1324,6 +1458,7 @@ void KateCompletionModel::Group::clear()
 {
     prefilter.clear();
     filtered.clear();
+    unsortedFrom = std::numeric_limits<size_t>::max();
     isEmpty = true;
 }
 
@@ -1513,6 +1648,7 @@ void KateCompletionModel::addCompletionModel(KTextEditor::CodeCompletionModel *m
             &KTextEditor::CodeCompletionModel::dataChanged,
             this,
             [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+                m_rowData.clear();
                 Q_EMIT dataChanged(mapFromSource(topLeft), mapFromSource(bottomRight), roles);
             });
 
@@ -1543,6 +1679,7 @@ void KateCompletionModel::setCompletionModels(const QList<KTextEditor::CodeCompl
                 &KTextEditor::CodeCompletionModel::dataChanged,
                 this,
                 [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+                    m_rowData.clear();
                     Q_EMIT dataChanged(mapFromSource(topLeft), mapFromSource(bottomRight), roles);
                 });
     }
@@ -1677,9 +1814,7 @@ void KateCompletionModel::updateBestMatches()
         for (const Item &item : m_ungrouped->filtered) {
             ModelRow source = item.sourceRow();
 
-            QVariant v = source.second.data(CodeCompletionModel::BestMatchesCount);
-
-            if (v.userType() == QMetaType::Int && v.toInt() > 0) {
+            if (bestMatchesCount(source) > 0) {
                 int quality = contextMatchQuality(source);
                 if (quality > 0) {
                     rowsForQuality.insert(quality, row);
@@ -1716,22 +1851,24 @@ void KateCompletionModel::updateBestMatches()
         return;
     }
 
-    ///@todo Cache the CodeCompletionModel::BestMatchesCount
     for (Group *g : m_rowTable) {
         if (g == m_bestMatches) {
             continue;
         }
         for (int a = 0; a < (int)g->filtered.size(); a++) {
+            if (size_t(a) == g->unsortedFrom) {
+                g->ensureSorted();
+            }
             ModelRow source = g->filtered[a].sourceRow();
 
-            QVariant v = source.second.data(CodeCompletionModel::BestMatchesCount);
-
-            if (v.userType() == QMetaType::Int && v.toInt() > 0) {
+            // cached, this visits all items each keystroke if the model provides no counts
+            const int count = bestMatchesCount(source);
+            if (count > 0) {
                 // Return the best match with any of the argument-hints
 
                 int quality = contextMatchQuality(source);
                 if (quality > 0) {
-                    matches.insert(quality, qMakePair(v.toInt(), g->filtered[a].sourceRow()));
+                    matches.insert(quality, qMakePair(count, g->filtered[a].sourceRow()));
                 }
                 --maxMatches;
             }
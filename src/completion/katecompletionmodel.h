@@ -9,6 +9,7 @@
 #define KATECOMPLETIONMODEL_H
 
 #include <QAbstractProxyModel>
+#include <QHash>
 #include <QList>
 #include <QPair>
 
@@ -17,6 +18,8 @@
 #include "expandingtree/expandingwidgetmodel.h"
 #include <ktexteditor_export.h>
 
+#include <array>
+#include <limits>
 #include <set>
 
 class KateCompletionWidget;
@@ -141,6 +144,19 @@ private:
     friend class KateArgumentHintModel;
     static ModelRow modelRowPair(const QModelIndex &index);
 
+    /// Number of columns shown, each merges some source columns, see m_columnMerges
+    static constexpr size_t mergedColumnCount = 3;
+
+    /// Source data not needed for filtering and sorting, fetched once a row is shown or
+    /// inspected for the best matches and kept across keystrokes until the source models change
+    struct RowData {
+        int bestMatchesCount = -1; // -1 if not fetched yet
+        std::array<QString, mergedColumnCount> display; // merged display text per column
+        std::array<bool, mergedColumnCount> hasDisplay = {};
+    };
+    RowData &rowData(const ModelRow &row) const;
+    int bestMatchesCount(const ModelRow &row) const;
+
     // Represents a source row; provides sorting method
     class Item
     {
@@ -197,7 +213,10 @@ public:
         void addItem(const Item &i, bool notifyModel = false);
         /// Removes the item specified by \a row.  Returns true if a change was made to rows.
         bool removeItem(const ModelRow &row);
+        /// Sorts the filtered items. Large groups only get their first items ordered,
+        /// the rest is sorted by ensureSorted() once something beyond them is accessed.
         void resort();
+        void ensureSorted();
         void clear();
         // Returns whether this group should be ordered before other
         bool orderBefore(Group *other) const;
@@ -209,6 +228,7 @@ public:
         ///@todo Implement an efficient way of doing this map, that does _not_ iterate over all items!
         int rowOf(const ModelRow &item)
         {
+            ensureSorted();
             for (int a = 0; a < (int)filtered.size(); ++a) {
                 if (filtered[a].sourceRow() == item) {
                     return a;
@@ -222,6 +242,8 @@ public:
         QString title, scope;
         std::vector<Item> filtered;
         std::vector<Item> prefilter;
+        /// Items of filtered from this one on are not sorted yet, the ones before are in final order
+        size_t unsortedFrom = std::numeric_limits<size_t>::max();
         bool isEmpty;
         //-1 if none was set
         int customSortingKey;
@@ -267,8 +289,12 @@ private:
         Change
     };
 
-    // Returns whether the model needs to be reset
-    void changeCompletions(Group *g);
+    /// Refilters the items of the group. When narrowing, only the items matching so far are checked again.
+    void changeCompletions(Group *g, changeTypes changeType);
+
+    /// Matches the items against the current completion, in parallel chunks for many items.
+    /// Afterwards matched[i] tells whether items[i] matches.
+    void matchItems(std::vector<Item> &items, std::vector<char> &matched);
 
     bool hasCompletionModel() const;
 
@@ -289,7 +315,7 @@ private:
     QMap<KTextEditor::CodeCompletionModel *, QString> m_currentMatch;
 
     // Column merging
-    const std::array<std::vector<int>, 3> m_columnMerges = {{
+    const std::array<std::vector<int>, mergedColumnCount> m_columnMerges = {{
         {0},
         {1, 2, 3, 4},
         {5},
@@ -301,6 +327,8 @@ private:
     Group *m_argumentHints; // The argument-hints will be passed on to another model, to be shown in another widget
     Group *m_bestMatches; // A temporary group used for holding the best matches of all visible items
 
+    mutable QHash<ModelRow, RowData> m_rowData;
+
     // Storing the sorted order
     std::vector<Group *> m_rowTable;
     std::vector<Group *> m_emptyGroups;
@@ -0,0 +1,97 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "katesharedwordindex.h"
+#include "katedocument.h"
+#include "katewordindex.h"
+
+#include <KFuzzyMatcher>
+
+#include <algorithm>
+#include <vector>
+
+KateSharedWordIndex::KateSharedWordIndex(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void KateSharedWordIndex::addDocument(KTextEditor::DocumentPrivate *document)
+{
+    // the index keeps itself up to date from then on
+    connect(document, &KTextEditor::DocumentPrivate::textChanged, this, [document] {
+        if (!document->hasWordIndex() && document->lines() <= maxDocumentLines) {
+            document->wordIndex();
+        }
+    });
+}
+
+void KateSharedWordIndex::addWord(const QString &word)
+{
+    ++m_words[word];
+    ++m_contributed;
+}
+
+void KateSharedWordIndex::removeWord(const QString &word)
+{
+    const auto it = m_words.find(word);
+    Q_ASSERT(it != m_words.end());
+    if (it != m_words.end() && --(*it) <= 0) {
+        m_words.erase(it);
+    }
+    --m_contributed;
+}
+
+QStringList KateSharedWordIndex::wordsWithPrefix(const QString &prefix, int minLength) const
+{
+    QStringList result;
+    for (auto it = m_words.lowerBound(prefix); it != m_words.cend() && it.key().startsWith(prefix); ++it) {
+        if (it.key().size() >= minLength) {
+            result.append(it.key());
+        }
+    }
+    return result;
+}
+
+QStringList KateSharedWordIndex::fuzzyMatches(const QString &pattern, int minLength, int limit) const
+{
+    if (pattern.isEmpty() || limit <= 0) {
+        return {};
+    }
+
+    // only the words starting with the first character, upper or lower case
+    std::vector<std::pair<int, QString>> scored;
+    const QChar lower = pattern.front().toLower();
+    const QChar upper = pattern.front().toUpper();
+    for (const QChar c : {upper, lower}) {
+        for (auto it = m_words.lowerBound(QString(c)); it != m_words.cend() && it.key().front() == c; ++it) {
+            if (it.key().size() < minLength) {
+                continue;
+            }
+            const auto match = KFuzzyMatcher::match(pattern, it.key());
+            if (match.matched) {
+                scored.emplace_back(match.score, it.key());
+            }
+        }
+        if (upper == lower) {
+            break;
+        }
+    }
+
+    // only the best ones need to be ordered
+    const auto end = scored.begin() + std::min<qsizetype>(limit, scored.size());
+    std::partial_sort(scored.begin(), end, scored.end(), [](const auto &a, const auto &b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    });
+
+    QStringList result;
+    result.reserve(end - scored.begin());
+    for (auto it = scored.begin(); it != end; ++it) {
+        result.append(it->second);
+    }
+    return result;
+}
+
+#include "moc_katesharedwordindex.cpp"
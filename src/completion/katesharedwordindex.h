@@ -0,0 +1,127 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_SHAREDWORDINDEX_H
+#define KATE_SHAREDWORDINDEX_H
+
+#include <QMap>
+#include <QObject>
+#include <QStringList>
+
+#include <ktexteditor_export.h>
+
+namespace KTextEditor
+{
+class DocumentPrivate;
+}
+
+class KateWordIndex;
+
+/**
+ * Words of all open documents, for word completion across documents.
+ *
+ * Each word knows in how many documents it occurs. The per document
+ * KateWordIndex objects report words they gain or lose completely, so
+ * closing a document removes exactly its words.
+ *
+ * Memory is bounded: documents with too many distinct words are left out,
+ * as are documents that would push the total above maxWords. A contributing
+ * document that grows beyond that withdraws its words.
+ *
+ * Queries don't update anything, the document indices update themselves
+ * shortly after their document changed.
+ */
+class KTEXTEDITOR_EXPORT KateSharedWordIndex : public QObject
+{
+    Q_OBJECT
+
+    friend class KateWordIndex;
+
+public:
+    /**
+     * Documents with more distinct words don't contribute.
+     */
+    static constexpr qsizetype maxDocumentWords = 100000;
+
+    /**
+     * Upper bound for the sum of the distinct words of all contributing documents.
+     */
+    static constexpr qsizetype maxWords = 1000000;
+
+    /**
+     * Documents with more lines are only indexed once their own word completion did so.
+     */
+    static constexpr int maxDocumentLines = 200000;
+
+    explicit KateSharedWordIndex(QObject *parent);
+
+    /**
+     * Create the word index of @p document once it has text, unless it is too large.
+     */
+    void addDocument(KTextEditor::DocumentPrivate *document);
+
+    /**
+     * Number of documents containing @p word.
+     */
+    int documentCount(const QString &word) const
+    {
+        return m_words.value(word);
+    }
+
+    /**
+     * Number of distinct words.
+     */
+    qsizetype size() const
+    {
+        return m_words.size();
+    }
+
+    /**
+     * All words of at least @p minLength characters starting with @p prefix, sorted.
+     */
+    QStringList wordsWithPrefix(const QString &prefix, int minLength) const;
+
+    /**
+     * The @p limit best fuzzy matches for @p pattern of at least @p minLength characters, best first.
+     * Only words starting with the first character of the pattern, in any case, are considered.
+     */
+    QStringList fuzzyMatches(const QString &pattern, int minLength, int limit) const;
+
+private:
+    /**
+     * A contributing document gained or lost a word completely.
+     */
+    void addWord(const QString &word);
+    void removeWord(const QString &word);
+
+    /**
+     * Is there room for one more word?
+     */
+    bool isFull() const
+    {
+        return m_contributed >= maxWords;
+    }
+
+    /**
+     * Can a document with that many words contribute?
+     */
+    bool hasRoomFor(qsizetype words) const
+    {
+        return words <= maxDocumentWords && m_contributed + words <= maxWords;
+    }
+
+    /**
+     * word => number of documents containing it
+     */
+    QMap<QString, int> m_words;
+
+    /**
+     * Sum of the distinct words of all contributing documents.
+     */
+    qsizetype m_contributed = 0;
+};
+
+#endif
@@ -10,7 +10,9 @@
 #include "kateconfig.h"
 #include "katedocument.h"
 #include "kateglobal.h"
+#include "katesharedwordindex.h"
 #include "kateview.h"
+#include "katewordindex.h"
 
 #include <ktexteditor/movingrange.h>
 #include <ktexteditor/range.h>
@@ -37,9 +39,6 @@
 
 // END
 
-/// amount of lines to scan backwards and forwards
-static const int maxLinesToScan = 10000;
-
 // BEGIN KateWordCompletionModel
 KateWordCompletionModel::KateWordCompletionModel(QObject *parent)
     : CodeCompletionModel(parent)
@@ -184,70 +183,87 @@ void KateWordCompletionModel::completionInvoked(KTextEditor::View *view, const K
 }
 
 /**
- * Scan throughout the entire document for possible completions,
- * ignoring any dublets and words shorter than configured and/or
- * reasonable minimum length.
+ * Words of the document starting like the typed word, from its word index, ignoring words
+ * shorter than configured and/or reasonable minimum length.
  */
 QStringList KateWordCompletionModel::allMatches(KTextEditor::View *view, const KTextEditor::Range &range)
 {
-    QSet<QStringView> result;
     const int minWordSize = qMax(2, qobject_cast<KTextEditor::ViewPrivate *>(view)->config()->wordCompletionMinimalWordLength());
     const auto cursorPosition = view->cursorPosition();
-    const auto document = view->document();
-    const int startLine = std::max(0, cursorPosition.line() - maxLinesToScan);
-    const int endLine = std::min(cursorPosition.line() + maxLinesToScan, view->document()->lines());
-    for (int line = startLine; line < endLine; line++) {
-        const QString text = document->line(line);
-        if (text.isEmpty() || text.isNull()) {
-            continue;
+    const auto document = static_cast<KTextEditor::DocumentPrivate *>(view->document());
+
+    // only the lines changed since the last completion are scanned again
+    KateWordIndex *index = document->wordIndex();
+    index->update();
+
+    // don't add the word we are inside with cursor or that we complete, unless it is somewhere else, too
+    QHash<QString, int> excluded;
+    auto excludeWords = [&](int line) {
+        if (line < 0 || line >= document->lines()) {
+            return;
         }
-        QStringView textView = text;
-        int wordBegin = 0;
-        int offset = 0;
-        const int end = text.size();
-        const bool cursorLine = cursorPosition.line() == line;
-        const bool isNotLastLine = line != range.end().line();
-        const QChar *d = text.data();
-        while (offset < end) {
-            const QChar c = d[offset];
-            // increment offset when at line end, so we take the last character too
-            if ((!c.isLetterOrNumber() && c != QChar(u'_')) || (offset == end - 1 && offset++)) {
-                if (offset - wordBegin >= minWordSize && (isNotLastLine || offset != range.end().column())) {
-                    // don't add the word we are inside with cursor!
-                    if (!cursorLine || (cursorPosition.column() < wordBegin || cursorPosition.column() > offset)) {
-                        result.insert(textView.mid(wordBegin, offset - wordBegin));
-                    }
-                }
-                wordBegin = offset + 1;
-            }
-            if (c.isSpace()) {
-                wordBegin = offset + 1;
+        KateWordIndex::forEachWord(document->line(line), [&](int wordBegin, QStringView word) {
+            const int wordEnd = wordBegin + word.size();
+            const bool atCursor = line == cursorPosition.line() && cursorPosition.column() >= wordBegin && cursorPosition.column() <= wordEnd;
+            const bool atRangeEnd = line == range.end().line() && wordEnd == range.end().column();
+            if (atCursor || atRangeEnd) {
+                ++excluded[word.toString()];
             }
-            offset += 1;
+        });
+    };
+    excludeWords(cursorPosition.line());
+    if (range.end().line() != cursorPosition.line()) {
+        excludeWords(range.end().line());
+    }
+
+    // only the own words the typed text can match, all of them if nothing is typed yet
+    const QString word = document->text(range);
+    m_matches.clear();
+    const QStringList words = index->wordsWithInitialOf(word, minWordSize);
+    m_matches.reserve(words.size());
+    for (const QString &word : words) {
+        if (index->count(word) > excluded.value(word)) {
+            m_matches.append(word);
         }
     }
 
+    // words of the other documents, by prefix and fuzzy, this document's own candidates are in already
+    QSet<QString> foreign;
+    if (KateSharedWordIndex *shared = KTextEditor::EditorPrivate::self()->sharedWordIndex(); shared && !word.isEmpty()) {
+        auto addForeign = [&](const QStringList &candidates) {
+            for (const QString &candidate : candidates) {
+                if (index->count(candidate) == 0 && !foreign.contains(candidate)) {
+                    foreign.insert(candidate);
+                    m_matches.append(candidate);
+                }
+            }
+        };
+        constexpr int maxFuzzyMatches = 100;
+        addForeign(shared->wordsWithPrefix(word, minWordSize));
+        addForeign(shared->fuzzyMatches(word, minWordSize, maxFuzzyMatches));
+    }
+
     // ensure words that are ok spell check wise always end up in the completion, see bug 468705
-    const auto language = static_cast<KTextEditor::DocumentPrivate *>(document)->defaultDictionary();
-    const auto word = view->document()->text(range);
-    Sonnet::Speller speller;
-    QStringList spellerSuggestions;
-    speller.setLanguage(language);
-    if (speller.isValid()) {
-        if (speller.isCorrect(word)) {
-            result.insert(word);
+    const QString language = document->defaultDictionary();
+    if (!m_speller || m_spellerLanguage != language) {
+        m_speller = std::make_unique<Sonnet::Speller>(language);
+        m_spellerLanguage = language;
+    }
+    if (m_speller->isValid()) {
+        QSet<QString> extra;
+        if (m_speller->isCorrect(word)) {
+            extra.insert(word);
         } else {
-            spellerSuggestions = speller.suggest(word);
-            for (const auto &alternative : std::as_const(spellerSuggestions)) {
-                result.insert(alternative);
+            const QStringList spellerSuggestions = m_speller->suggest(word);
+            for (const auto &alternative : spellerSuggestions) {
+                extra.insert(alternative);
+            }
+        }
+        for (const QString &alternative : std::as_const(extra)) {
+            if ((index->count(alternative) <= excluded.value(alternative) && !foreign.contains(alternative)) || alternative.size() < minWordSize) {
+                m_matches.append(alternative);
             }
         }
-    }
-
-    m_matches.clear();
-    m_matches.reserve(result.size());
-    for (auto v : std::as_const(result)) {
-        m_matches << v.toString();
     }
 
     return m_matches;
@@ -19,6 +19,13 @@
 #include "katepartdebug.h"
 #include <ktexteditor_export.h>
 
+#include <memory>
+
+namespace Sonnet
+{
+class Speller;
+}
+
 class KateWordCompletionModel : public KTextEditor::CodeCompletionModel, public KTextEditor::CodeCompletionModelControllerInterface
 {
     Q_OBJECT
@@ -60,6 +67,10 @@ public:
 private:
     QStringList m_matches;
     bool m_automatic;
+
+    // kept around, creating a speller loads its dictionary
+    std::unique_ptr<Sonnet::Speller> m_speller;
+    QString m_spellerLanguage;
 };
 
 class KateWordCompletionView : public QObject
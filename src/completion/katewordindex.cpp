@@ -0,0 +1,246 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "katewordindex.h"
+#include "katebuffer.h"
+#include "katedocument.h"
+#include "kateglobal.h"
+#include "katesharedwordindex.h"
+
+#include <algorithm>
+
+/**
+ * Call @p func with the case folded first character of each word part after the first one.
+ * Parts begin after an underscore or at a capital, like in KateCompletionModel's containsAtWordBeginning(),
+ * and at the first letter after leading non-letters, which the abbreviation match starts with.
+ */
+template<typename Func>
+static void forEachPartInitial(QStringView word, Func func)
+{
+    bool seenLetter = word.front().isLetter();
+    for (qsizetype i = 1; i < word.size(); ++i) {
+        const QChar c = word[i];
+        const QChar prev = word[i - 1];
+        if (prev == u'_' || (c.isUpper() && !prev.isUpper()) || (!seenLetter && c.isLetter())) {
+            func(c.toCaseFolded());
+        }
+        seenLetter = seenLetter || c.isLetter();
+    }
+}
+
+KateWordIndex::KateWordIndex(KTextEditor::DocumentPrivate *document)
+    : QObject(document)
+    , m_document(document)
+    , m_shared(KTextEditor::EditorPrivate::self()->sharedWordIndex())
+{
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(500);
+    connect(&m_updateTimer, &QTimer::timeout, this, &KateWordIndex::update);
+
+    // any change of the buffer is followed by one of these
+    connect(document, &KTextEditor::DocumentPrivate::textChanged, this, [this] {
+        m_dirty = true;
+        m_updateTimer.start();
+    });
+    connect(document, &KTextEditor::DocumentPrivate::aboutToInvalidateMovingInterfaceContent, this, [this] {
+        m_dirty = true;
+        m_updateTimer.start();
+    });
+    m_updateTimer.start();
+}
+
+KateWordIndex::~KateWordIndex()
+{
+    // a closed document takes its words with it
+    if (isShared()) {
+        for (auto it = m_words.cbegin(); it != m_words.cend(); ++it) {
+            m_shared->removeWord(it.key());
+        }
+    }
+}
+
+void KateWordIndex::update()
+{
+    m_updateTimer.stop();
+    if (!m_dirty) {
+        return;
+    }
+    m_dirty = false;
+
+    // blocks unchanged since the last update still share their lines with our old snapshot
+    const Kate::TextSnapshot snapshot = m_document->buffer().snapshot();
+    QSet<const Kate::TextLine *> oldBlocks;
+    oldBlocks.reserve(m_snapshot.blocks().size());
+    for (const auto &block : m_snapshot.blocks()) {
+        oldBlocks.insert(block.constData());
+    }
+
+    QSet<const Kate::TextLine *> newBlocks;
+    newBlocks.reserve(snapshot.blocks().size());
+    for (const auto &block : snapshot.blocks()) {
+        newBlocks.insert(block.constData());
+        if (!oldBlocks.contains(block.constData())) {
+            addLines(block, 1);
+        }
+    }
+
+    for (const auto &block : m_snapshot.blocks()) {
+        if (!newBlocks.contains(block.constData())) {
+            addLines(block, -1);
+        }
+    }
+
+    m_snapshot = snapshot;
+    updateSharedIndex();
+}
+
+void KateWordIndex::updateSharedIndex()
+{
+    if (!m_shared) {
+        return;
+    }
+
+    // grown too large: withdraw all our words
+    if (m_contributing && m_words.size() > KateSharedWordIndex::maxDocumentWords) {
+        withdrawFromSharedIndex();
+        return;
+    }
+
+    // (again) small enough: join
+    if (!m_contributing && m_shared->hasRoomFor(m_words.size())) {
+        m_contributing = true;
+        for (auto it = m_words.cbegin(); it != m_words.cend(); ++it) {
+            m_shared->addWord(it.key());
+        }
+    }
+}
+
+void KateWordIndex::withdrawFromSharedIndex()
+{
+    m_contributing = false;
+    for (auto it = m_words.cbegin(); it != m_words.cend(); ++it) {
+        m_shared->removeWord(it.key());
+    }
+}
+
+void KateWordIndex::addLines(const QList<Kate::TextLine> &lines, int delta)
+{
+    for (const Kate::TextLine &line : lines) {
+        forEachWord(line.text(), [this, delta](int, QStringView word) {
+            if (word.size() < minimalWordLength) {
+                return;
+            }
+
+            if (delta > 0) {
+                // a new word while the shared index is full: it is over the global bound, we leave
+                const QString key = word.toString();
+                if (isShared() && m_shared->isFull() && !m_words.contains(key)) {
+                    withdrawFromSharedIndex();
+                }
+                int &count = m_words[key];
+                if (count == 0) {
+                    addWordParts(key);
+                    if (isShared()) {
+                        m_shared->addWord(key);
+                    }
+                }
+                count += delta;
+                return;
+            }
+
+            auto it = m_words.find(word.toString());
+            Q_ASSERT(it != m_words.end());
+            if (it != m_words.end() && (*it += delta) <= 0) {
+                if (isShared()) {
+                    m_shared->removeWord(it.key());
+                }
+                removeWordParts(it.key());
+                m_words.erase(it);
+            }
+        });
+    }
+}
+
+void KateWordIndex::addWordParts(const QString &word)
+{
+    forEachPartInitial(word, [this, &word](QChar initial) {
+        m_wordsByPart[initial].insert(word);
+    });
+}
+
+void KateWordIndex::removeWordParts(const QString &word)
+{
+    forEachPartInitial(word, [this, &word](QChar initial) {
+        auto it = m_wordsByPart.find(initial);
+        if (it != m_wordsByPart.end()) {
+            it->remove(word);
+            if (it->isEmpty()) {
+                m_wordsByPart.erase(it);
+            }
+        }
+    });
+}
+
+QStringList KateWordIndex::words(int minLength) const
+{
+    QStringList result;
+    result.reserve(m_words.size());
+    for (auto it = m_words.cbegin(); it != m_words.cend(); ++it) {
+        if (it.key().size() >= minLength) {
+            result.append(it.key());
+        }
+    }
+    return result;
+}
+
+QStringList KateWordIndex::wordsWithPrefix(const QString &prefix, int minLength) const
+{
+    QStringList result;
+    for (auto it = m_words.lowerBound(prefix); it != m_words.cend() && it.key().startsWith(prefix); ++it) {
+        if (it.key().size() >= minLength) {
+            result.append(it.key());
+        }
+    }
+    return result;
+}
+
+QStringList KateWordIndex::wordsWithInitialOf(const QString &typed, int minLength) const
+{
+    if (typed.isEmpty()) {
+        return words(minLength);
+    }
+
+    QStringList result;
+    const QChar lower = typed.front().toLower();
+    const QChar upper = typed.front().toUpper();
+    for (const QChar c : {upper, lower}) {
+        for (auto it = m_words.lowerBound(QString(c)); it != m_words.cend() && it.key().front() == c; ++it) {
+            if (it.key().size() >= minLength) {
+                result.append(it.key());
+            }
+        }
+        if (upper == lower) {
+            break;
+        }
+    }
+
+    // words with a later part starting like the typed word, e.g. BarFoo for Foo, unless listed already
+    const auto parts = m_wordsByPart.constFind(typed.front().toCaseFolded());
+    if (parts != m_wordsByPart.cend()) {
+        const qsizetype initialMatches = result.size();
+        for (const QString &word : *parts) {
+            if (word.size() >= minLength && word.front() != upper && word.front() != lower) {
+                result.append(word);
+            }
+        }
+        if (result.size() > initialMatches) {
+            std::sort(result.begin(), result.end());
+        }
+    }
+    return result;
+}
+
+#include "moc_katewordindex.cpp"
@@ -0,0 +1,161 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_WORDINDEX_H
+#define KATE_WORDINDEX_H
+
+#include "katetextsnapshot.h"
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+#include <ktexteditor_export.h>
+
+namespace KTextEditor
+{
+class DocumentPrivate;
+}
+
+class KateSharedWordIndex;
+
+/**
+ * All words of a document with the number of their occurrences, shared by all views of the document.
+ *
+ * The index remembers the buffer snapshot it was built from. On update() only the blocks
+ * that changed since then are rescanned: unchanged blocks still share their line list with
+ * the remembered snapshot, a changed block has a new one. The index updates itself shortly
+ * after the document changed, so other documents can query the shared index without work.
+ *
+ * The words are also reported to the editor wide KateSharedWordIndex, as long as
+ * it has room for them.
+ */
+class KTEXTEDITOR_EXPORT KateWordIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Words shorter than this are not indexed.
+     */
+    static constexpr int minimalWordLength = 2;
+
+    explicit KateWordIndex(KTextEditor::DocumentPrivate *document);
+    ~KateWordIndex() override;
+
+    /**
+     * Bring the index up to date with the document, cheap if nothing changed.
+     */
+    void update();
+
+    /**
+     * Occurrences of @p word in the document as of the last update().
+     */
+    int count(const QString &word) const
+    {
+        return m_words.value(word);
+    }
+
+    /**
+     * Are our words part of the shared index?
+     */
+    bool isShared() const
+    {
+        return m_shared && m_contributing;
+    }
+
+    /**
+     * Number of distinct words.
+     */
+    int size() const
+    {
+        return m_words.size();
+    }
+
+    /**
+     * All words of at least @p minLength characters, sorted.
+     */
+    QStringList words(int minLength) const;
+
+    /**
+     * All words of at least @p minLength characters starting with @p prefix, sorted.
+     * This only visits the matching words.
+     */
+    QStringList wordsWithPrefix(const QString &prefix, int minLength) const;
+
+    /**
+     * All words of at least @p minLength characters the completion widget can match against @p typed, sorted.
+     * These start with the first character of @p typed in any case, or have a later word part starting
+     * with it, like BarFoo or bar_foo for Foo. Only the candidates are visited.
+     */
+    QStringList wordsWithInitialOf(const QString &typed, int minLength) const;
+
+    /**
+     * Call @p func with the start column and the text of each word in @p text.
+     * Words are runs of letters, numbers and underscores.
+     */
+    template<typename Func>
+    static void forEachWord(QStringView text, Func func)
+    {
+        qsizetype wordBegin = -1;
+        for (qsizetype offset = 0; offset <= text.size(); ++offset) {
+            const bool wordChar = offset < text.size() && (text[offset].isLetterOrNumber() || text[offset] == u'_');
+            if (wordChar && wordBegin < 0) {
+                wordBegin = offset;
+            } else if (!wordChar && wordBegin >= 0) {
+                func(int(wordBegin), text.mid(wordBegin, offset - wordBegin));
+                wordBegin = -1;
+            }
+        }
+    }
+
+private:
+    void addLines(const QList<Kate::TextLine> &lines, int delta);
+    void addWordParts(const QString &word);
+    void removeWordParts(const QString &word);
+    void updateSharedIndex();
+    void withdrawFromSharedIndex();
+
+private:
+    KTextEditor::DocumentPrivate *const m_document;
+
+    /**
+     * Buffer state the index corresponds to.
+     */
+    Kate::TextSnapshot m_snapshot;
+
+    /**
+     * Did the document change since the last update?
+     */
+    bool m_dirty = true;
+
+    /**
+     * Collects changes of the document into one update().
+     */
+    QTimer m_updateTimer;
+
+    /**
+     * word => occurrences, sorted for prefix queries
+     */
+    QMap<QString, int> m_words;
+
+    /**
+     * case folded first character of a later word part => words, for the widget's word beginning matches
+     */
+    QHash<QChar, QSet<QString>> m_wordsByPart;
+
+    /**
+     * Editor wide index we report to, m_contributing tells if it currently contains our words.
+     */
+    QPointer<KateSharedWordIndex> m_shared;
+    bool m_contributing = false;
+};
+
+#endif
@@ -345,6 +345,9 @@ void KateSpellCheckConfigTab::apply()
     KateDocumentConfig::global()->setOnTheFlySpellCheck(settings.value(QStringLiteral("checkerEnabledByDefault"), false).toBool());
     KateDocumentConfig::global()->configEnd();
 
+    // the settings decide what is misspelled, results from before are stale
+    KTextEditor::EditorPrivate::self()->spellCheckManager()->settingsChanged();
+
     const auto docs = KTextEditor::EditorPrivate::self()->documents();
     for (KTextEditor::Document *doc : docs) {
         static_cast<KTextEditor::DocumentPrivate *>(doc)->refreshOnTheFlyCheck();
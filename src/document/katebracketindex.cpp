@@ -0,0 +1,206 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "katebracketindex.h"
+#include "katebuffer.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+KateBracketIndex::KateBracketIndex(KateBuffer &buffer)
+    : m_buffer(buffer)
+{
+}
+
+KTextEditor::Cursor KateBracketIndex::findMatchingBracket(KTextEditor::Cursor position, QChar opening, QChar closing, int maxLines)
+{
+    const int startLine = position.line();
+    if (startLine < 0 || startLine >= m_buffer.lines() || maxLines < 0 || opening == closing) {
+        return KTextEditor::Cursor::invalid();
+    }
+
+    // highlighting of the bracket line is required for the attribute
+    m_buffer.ensureHighlighted(startLine, 0);
+    const Kate::TextLine textLine = m_buffer.plainLine(startLine);
+    const QChar bracket = textLine.at(position.column());
+    if (bracket != opening && bracket != closing) {
+        return KTextEditor::Cursor::invalid();
+    }
+    const int attribute = textLine.attribute(position.column());
+
+    // all lines in front of the bracket are highlighted already
+    if (bracket == closing) {
+        updateSnapshot();
+        return search(position, false, opening, closing, attribute, std::max(startLine - maxLines, 0));
+    }
+
+    // highlight in growing windows, most matches are close by and the highlighting is the expensive part
+    const int maxLine = std::min(startLine + maxLines, m_buffer.lines() - 1);
+    for (int windowLines = 64;; windowLines *= 2) {
+        const int lastLine = std::min(startLine + windowLines, maxLine);
+        m_buffer.ensureHighlighted(lastLine, 0);
+        updateSnapshot();
+
+        const KTextEditor::Cursor match = search(position, true, opening, closing, attribute, lastLine);
+        if (match.isValid() || lastLine == maxLine) {
+            return match;
+        }
+    }
+}
+
+void KateBracketIndex::updateSnapshot()
+{
+    Kate::TextSnapshot snapshot = m_buffer.snapshot();
+    const auto &oldBlocks = m_snapshot.blocks();
+    const auto &newBlocks = snapshot.blocks();
+
+    // unchanged blocks keep their line list, nothing to do if all are unchanged
+    const bool unchanged = std::equal(oldBlocks.cbegin(), oldBlocks.cend(), newBlocks.cbegin(), newBlocks.cend(), [](const auto &a, const auto &b) {
+        return a.constData() == b.constData();
+    });
+    m_snapshot = snapshot;
+    if (unchanged) {
+        return;
+    }
+
+    QSet<const Kate::TextLine *> blocks;
+    blocks.reserve(newBlocks.size());
+    m_blockStartLines.clear();
+    m_blockStartLines.reserve(newBlocks.size());
+    int line = 0;
+    for (const auto &block : newBlocks) {
+        blocks.insert(block.constData());
+        m_blockStartLines.push_back(line);
+        line += block.size();
+    }
+
+    for (auto it = m_summaries.begin(); it != m_summaries.end();) {
+        it->removeIf([&blocks](const auto &summary) {
+            return !blocks.contains(summary.key());
+        });
+        it = it->isEmpty() ? m_summaries.erase(it) : std::next(it);
+    }
+}
+
+KateBracketIndex::Summary KateBracketIndex::summary(int block, QChar opening, QChar closing, int attribute)
+{
+    const quint64 key = (quint64(opening.unicode()) << 48) | (quint64(closing.unicode()) << 32) | quint32(attribute);
+    const auto &lines = m_snapshot.blocks().at(block);
+    BlockSummaries &summaries = m_summaries[key];
+    const auto it = summaries.constFind(lines.constData());
+    if (it != summaries.cend()) {
+        return *it;
+    }
+
+    Summary summary;
+    for (const Kate::TextLine &line : lines) {
+        const QString &text = line.text();
+        for (int col = 0; col < text.size(); ++col) {
+            const QChar c = text.at(col);
+            if ((c != opening && c != closing) || line.attribute(col) != attribute) {
+                continue;
+            }
+            summary.total += (c == closing) ? 1 : -1;
+            summary.maxPrefix = std::max(summary.maxPrefix, summary.total);
+        }
+    }
+    summaries.insert(lines.constData(), summary);
+    return summary;
+}
+
+KTextEditor::Cursor KateBracketIndex::search(KTextEditor::Cursor position, bool forward, QChar opening, QChar closing, int attribute, int limitLine)
+{
+    const auto &blocks = m_snapshot.blocks();
+    const int startLine = position.line();
+    const int startBlock = std::upper_bound(m_blockStartLines.cbegin(), m_blockStartLines.cend(), startLine) - m_blockStartLines.cbegin() - 1;
+    auto blockEnd = [&](int block) {
+        return m_blockStartLines[block] + int(blocks[block].size()) - 1;
+    };
+
+    // scan the lines in the given range of a block in search direction
+    int depth = 0;
+    auto scanLines = [&](int block, int from, int to, KTextEditor::Cursor &match) {
+        const auto &lines = blocks[block];
+        for (int line = from; forward ? line <= to : line >= to; forward ? ++line : --line) {
+            const Kate::TextLine &textLine = lines[line - m_blockStartLines[block]];
+            const int column = scanLine(textLine, forward ? 0 : textLine.length() - 1, forward, opening, closing, attribute, depth);
+            if (column >= 0) {
+                match = KTextEditor::Cursor(line, column);
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // the rest of the bracket line, then the rest of its block
+    KTextEditor::Cursor match = KTextEditor::Cursor::invalid();
+    const int column = scanLine(blocks[startBlock][startLine - m_blockStartLines[startBlock]],
+                                position.column() + (forward ? 1 : -1),
+                                forward,
+                                opening,
+                                closing,
+                                attribute,
+                                depth);
+    if (column >= 0) {
+        return KTextEditor::Cursor(startLine, column);
+    }
+
+    if (forward) {
+        if (scanLines(startBlock, startLine + 1, std::min(blockEnd(startBlock), limitLine), match)) {
+            return match;
+        }
+        for (int block = startBlock + 1; block < int(blocks.size()) && m_blockStartLines[block] <= limitLine; ++block) {
+            // skip blocks whose brackets never reach the match
+            if (blockEnd(block) <= limitLine) {
+                const Summary s = summary(block, opening, closing, attribute);
+                if (depth + s.maxPrefix < 1) {
+                    depth += s.total;
+                    continue;
+                }
+            }
+            if (scanLines(block, m_blockStartLines[block], std::min(blockEnd(block), limitLine), match)) {
+                return match;
+            }
+        }
+    } else {
+        if (scanLines(startBlock, startLine - 1, std::max(m_blockStartLines[startBlock], limitLine), match)) {
+            return match;
+        }
+        for (int block = startBlock - 1; block >= 0 && blockEnd(block) >= limitLine; --block) {
+            // in backward direction opening counts +1, the suffixes of the block matter
+            if (m_blockStartLines[block] >= limitLine) {
+                const Summary s = summary(block, opening, closing, attribute);
+                if (depth - (s.total - s.maxPrefix) < 1) {
+                    depth -= s.total;
+                    continue;
+                }
+            }
+            if (scanLines(block, blockEnd(block), std::max(m_blockStartLines[block], limitLine), match)) {
+                return match;
+            }
+        }
+    }
+
+    return KTextEditor::Cursor::invalid();
+}
+
+int KateBracketIndex::scanLine(const Kate::TextLine &line, int from, bool forward, QChar opening, QChar closing, int attribute, int &depth)
+{
+    const QString &text = line.text();
+    for (int col = forward ? from : std::min(from, int(text.size()) - 1); forward ? col < text.size() : col >= 0; forward ? ++col : --col) {
+        const QChar c = text.at(col);
+        if ((c != opening && c != closing) || line.attribute(col) != attribute) {
+            continue;
+        }
+        // the bracket searched for counts +1
+        depth += ((c == closing) == forward) ? 1 : -1;
+        if (depth == 1) {
+            return col;
+        }
+    }
+    return -1;
+}
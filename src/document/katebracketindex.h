@@ -0,0 +1,100 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_BRACKETINDEX_H
+#define KATE_BRACKETINDEX_H
+
+#include "katetextsnapshot.h"
+
+#include <ktexteditor/cursor.h>
+
+#include <QHash>
+
+#include <ktexteditor_export.h>
+
+#include <vector>
+
+class KateBuffer;
+
+/**
+ * Finds matching brackets without walking the document character by character.
+ *
+ * For each bracket pair and attribute the index remembers a summary of every buffer block:
+ * the net bracket depth and how deep the brackets get inside. A search skips all blocks
+ * that can't contain the match and only scans the lines of the block that does.
+ *
+ * The summaries are keyed by the line list of a block in the remembered buffer snapshot,
+ * a block changed by editing or highlighting gets a new one and is summarized again.
+ */
+class KTEXTEDITOR_EXPORT KateBracketIndex
+{
+public:
+    explicit KateBracketIndex(KateBuffer &buffer);
+
+    /**
+     * Search the bracket matching the one at @p position.
+     * Only brackets with the same attribute as the one at @p position count.
+     * @param position position of the bracket to match
+     * @param opening the opening bracket of the pair
+     * @param closing the closing bracket of the pair
+     * @param maxLines maximal number of lines to search before or after @p position
+     * @return position of the matching bracket or an invalid cursor
+     */
+    KTextEditor::Cursor findMatchingBracket(KTextEditor::Cursor position, QChar opening, QChar closing, int maxLines);
+
+private:
+    /**
+     * Brackets of one block, closing counts +1 and opening -1 in document order.
+     * The minimal sum of a suffix is total - maxPrefix.
+     */
+    struct Summary {
+        int total = 0;
+        int maxPrefix = 0;
+    };
+
+    typedef QHash<const Kate::TextLine *, Summary> BlockSummaries;
+
+    /**
+     * Take a new snapshot of the buffer, drop the summaries of blocks that are gone.
+     */
+    void updateSnapshot();
+
+    /**
+     * Summary of the given block for the given brackets and attribute, computed on first use.
+     */
+    Summary summary(int block, QChar opening, QChar closing, int attribute);
+
+    /**
+     * Search the matching bracket in the lines of m_snapshot up to @p limitLine, see findMatchingBracket().
+     */
+    KTextEditor::Cursor search(KTextEditor::Cursor position, bool forward, QChar opening, QChar closing, int attribute, int limitLine);
+
+    /**
+     * Scan the columns of a line in search direction, ending at the first bracket that brings @p depth to 1.
+     * @return column of that bracket or -1 if there is none
+     */
+    static int scanLine(const Kate::TextLine &line, int from, bool forward, QChar opening, QChar closing, int attribute, int &depth);
+
+private:
+    KateBuffer &m_buffer;
+
+    /**
+     * Keeps the summarized blocks alive, so a changed block always gets a new line list.
+     */
+    Kate::TextSnapshot m_snapshot;
+
+    /**
+     * first line of each block in m_snapshot
+     */
+    std::vector<int> m_blockStartLines;
+
+    /**
+     * bracket pair and attribute => summaries of the blocks
+     */
+    QHash<quint64, BlockSummaries> m_summaries;
+};
+
+#endif
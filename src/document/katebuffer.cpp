@@ -25,6 +25,8 @@
 #include <QStringEncoder>
 #include <QTextStream>
 
+#include <limits>
+
 /**
  * Create an empty buffer. (with one block with one empty line)
  */
@@ -74,6 +76,11 @@ void KateBuffer::editEnd()
 
 void KateBuffer::updateHighlighting()
 {
+    // folding ranges only looking at lines in front of the changed ones stay valid
+    if (editingMinimalLineChanged() != -1) {
+        invalidateFoldingCache(editingMinimalLineChanged());
+    }
+
     // no highlighting, nothing to do
     if (!m_highlight) {
         return;
@@ -101,6 +108,7 @@ void KateBuffer::clear()
 
     // back to line 0 with hl
     m_lineHighlighted = 0;
+    m_foldingCache.clear();
 }
 
 bool KateBuffer::openFile(const QString &m_file, bool enforceTextCodec)
@@ -256,6 +264,18 @@ void KateBuffer::ensureHighlighted(int line, int lookAhead)
     doHighlight(m_lineHighlighted, end, false);
 }
 
+void KateBuffer::rehighlightLine(int line)
+{
+    // not highlighted yet, will be done on demand
+    if (!m_highlight || line < 0 || line >= m_lineHighlighted) {
+        return;
+    }
+
+    // look one line too far, needed for linecontinue stuff
+    // invalidate: repaint and respell the lines, a context change makes the following lines highlight again on demand
+    doHighlight(line, line + 1, true);
+}
+
 void KateBuffer::wrapLine(const KTextEditor::Cursor position)
 {
     // call original
@@ -319,6 +339,14 @@ void KateBuffer::setHighlight(int hlMode)
 void KateBuffer::invalidateHighlighting()
 {
     m_lineHighlighted = 0;
+    m_foldingCache.clear();
+}
+
+void KateBuffer::invalidateFoldingCache(int line)
+{
+    m_foldingCache.removeIf([line](QHash<int, FoldingCacheEntry>::iterator it) {
+        return it->lastLine >= line;
+    });
 }
 
 void KateBuffer::doHighlight(int startLine, int endLine, bool invalidate)
@@ -425,6 +453,11 @@ KateHighlighting::Foldings KateBuffer::computeFoldings(int line)
     return foldings;
 }
 
+/**
+ * Maximal number of empty lines to skip when looking for an indentation based folding start
+ */
+static constexpr int foldingLookAheadLimit = 64;
+
 std::pair<bool, bool> KateBuffer::isFoldingStartingOnLine(int startLine)
 {
     // ensure valid input
@@ -437,38 +470,103 @@ std::pair<bool, bool> KateBuffer::isFoldingStartingOnLine(int startLine)
         return {false, false};
     }
 
+    // known since the last change of the lines we looked at?
+    const auto cached = m_foldingCache.constFind(startLine);
+    if (cached != m_foldingCache.cend()) {
+        return cached->start;
+    }
+
     // first: get the wanted start line highlighted
     ensureHighlighted(startLine);
     const auto startTextLine = plainLine(startLine);
 
+    // remember the result together with the last line it depends on
+    const auto cacheResult = [this, startLine](std::pair<bool, bool> start, int lastLine) {
+        FoldingCacheEntry &entry = m_foldingCache[startLine];
+        entry.start = start;
+        entry.lastLine = lastLine;
+        return start;
+    };
+
     // we prefer token based folding
     if (startTextLine.markedAsFoldingStartAttribute()) {
-        return {true, false};
+        return cacheResult({true, false}, startLine);
     }
 
     // check for indentation based folding
+    int line = startLine;
     if (m_highlight->foldingIndentationSensitive() && (tabWidth() > 0) && startTextLine.highlightingState().indentationBasedFoldingEnabled()
         && !m_highlight->isEmptyLine(&startTextLine)) {
         // do some look ahead if this line might be a folding start
         // we limit this to avoid runtime disaster
         int linesVisited = 0;
-        while (startLine + 1 < lines()) {
-            const auto nextLine = plainLine(++startLine);
+        while (line + 1 < lines()) {
+            const auto nextLine = plainLine(++line);
             if (!m_highlight->isEmptyLine(&nextLine)) {
                 const bool foldingStart = startTextLine.indentDepth(tabWidth()) < nextLine.indentDepth(tabWidth());
-                return {foldingStart, foldingStart};
+                return cacheResult({foldingStart, foldingStart}, line);
             }
 
             // ensure some sensible limit of look ahead
-            constexpr int lookAheadLimit = 64;
-            if (++linesVisited > lookAheadLimit) {
+            if (++linesVisited > foldingLookAheadLimit) {
                 break;
             }
         }
     }
 
     // no folding start of any kind
-    return {false, false};
+    return cacheResult({false, false}, line);
+}
+
+/**
+ * Search the first folding region that stays open in a line.
+ * @param foldings folding vector of the line
+ * @return region type and offset of its first opening or -1, -1 if nothing stays open
+ */
+static std::pair<int, int> openedFoldingRegion(const KateHighlighting::Foldings &foldings)
+{
+    // mapping of type to "first" offset of it and current number of not matched openings
+    QHash<int, QPair<int, int>> foldingStartToOffsetAndCount;
+
+    // walk over all attributes of the line and compute the matchings
+    for (const auto &folding : foldings) {
+        // folding close?
+        if (folding.foldingRegion.type() == KSyntaxHighlighting::FoldingRegion::End) {
+            // search for this type, try to decrement counter, perhaps erase element!
+            auto end = foldingStartToOffsetAndCount.find(folding.foldingRegion.id());
+            if (end != foldingStartToOffsetAndCount.end()) {
+                if (end.value().second > 1) {
+                    --(end.value().second);
+                } else {
+                    foldingStartToOffsetAndCount.erase(end);
+                }
+            }
+        }
+
+        // folding open?
+        if (folding.foldingRegion.type() == KSyntaxHighlighting::FoldingRegion::Begin) {
+            // search for this type, either insert it, with current offset or increment counter!
+            auto start = foldingStartToOffsetAndCount.find(folding.foldingRegion.id());
+            if (start != foldingStartToOffsetAndCount.end()) {
+                ++(start.value().second);
+            } else {
+                foldingStartToOffsetAndCount.insert(folding.foldingRegion.id(), qMakePair(folding.offset, 1));
+            }
+        }
+    }
+
+    // compute first type with offset
+    int openedRegionType = -1;
+    int openedRegionOffset = -1;
+    QHashIterator<int, QPair<int, int>> hashIt(foldingStartToOffsetAndCount);
+    while (hashIt.hasNext()) {
+        hashIt.next();
+        if (openedRegionOffset == -1 || hashIt.value().first < openedRegionOffset) {
+            openedRegionType = hashIt.key();
+            openedRegionOffset = hashIt.value().first;
+        }
+    }
+    return {openedRegionType, openedRegionOffset};
 }
 
 KTextEditor::Range KateBuffer::computeFoldingRangeForStartLine(int startLine)
@@ -479,6 +577,24 @@ KTextEditor::Range KateBuffer::computeFoldingRangeForStartLine(int startLine)
         return KTextEditor::Range::invalid();
     }
 
+    // computed since the last change of the lines we looked at?
+    const auto cached = m_foldingCache.constFind(startLine);
+    if (cached != m_foldingCache.cend() && cached->rangeComputed) {
+        return cached->range;
+    }
+
+    // compute and remember it, isFoldingStartingOnLine did create the entry
+    int lastLine = startLine;
+    const KTextEditor::Range range = computeFoldingRange(startLine, foldingIndentationSensitive, lastLine);
+    FoldingCacheEntry &entry = m_foldingCache[startLine];
+    entry.range = range;
+    entry.rangeComputed = true;
+    entry.lastLine = qMax(entry.lastLine, lastLine);
+    return range;
+}
+
+KTextEditor::Range KateBuffer::computeFoldingRange(int startLine, bool foldingIndentationSensitive, int &dependsOnLine)
+{
     // now: decided if indentation based folding or not!
     if (foldingIndentationSensitive) {
         // get our start indentation level
@@ -505,6 +621,9 @@ KTextEditor::Range KateBuffer::computeFoldingRangeForStartLine(int startLine)
             break;
         }
 
+        // the range ends in front of the line we stopped at
+        dependsOnLine = qMin(lastLine, lines() - 1);
+
         // lastLine is always one too much
         --lastLine;
 
@@ -530,50 +649,7 @@ KTextEditor::Range KateBuffer::computeFoldingRangeForStartLine(int startLine)
     // 'normal' attribute based folding, aka token based like '{' BLUB '}'
 
     // first step: search the first region type, that stays open for the start line
-    int openedRegionType = -1;
-    int openedRegionOffset = -1;
-    {
-        // mapping of type to "first" offset of it and current number of not matched openings
-        QHash<int, QPair<int, int>> foldingStartToOffsetAndCount;
-
-        // walk over all attributes of the line and compute the matchings
-        const auto startLineAttributes = computeFoldings(startLine);
-        for (size_t i = 0; i < startLineAttributes.size(); ++i) {
-            // folding close?
-            if (startLineAttributes[i].foldingRegion.type() == KSyntaxHighlighting::FoldingRegion::End) {
-                // search for this type, try to decrement counter, perhaps erase element!
-                auto end = foldingStartToOffsetAndCount.find(startLineAttributes[i].foldingRegion.id());
-                if (end != foldingStartToOffsetAndCount.end()) {
-                    if (end.value().second > 1) {
-                        --(end.value().second);
-                    } else {
-                        foldingStartToOffsetAndCount.erase(end);
-                    }
-                }
-            }
-
-            // folding open?
-            if (startLineAttributes[i].foldingRegion.type() == KSyntaxHighlighting::FoldingRegion::Begin) {
-                // search for this type, either insert it, with current offset or increment counter!
-                auto start = foldingStartToOffsetAndCount.find(startLineAttributes[i].foldingRegion.id());
-                if (start != foldingStartToOffsetAndCount.end()) {
-                    ++(start.value().second);
-                } else {
-                    foldingStartToOffsetAndCount.insert(startLineAttributes[i].foldingRegion.id(), qMakePair(startLineAttributes[i].offset, 1));
-                }
-            }
-        }
-
-        // compute first type with offset
-        QHashIterator<int, QPair<int, int>> hashIt(foldingStartToOffsetAndCount);
-        while (hashIt.hasNext()) {
-            hashIt.next();
-            if (openedRegionOffset == -1 || hashIt.value().first < openedRegionOffset) {
-                openedRegionType = hashIt.key();
-                openedRegionOffset = hashIt.value().first;
-            }
-        }
-    }
+    const auto [openedRegionType, openedRegionOffset] = openedFoldingRegion(computeFoldings(startLine));
 
     // no opening region found, bad, nothing to do
     if (openedRegionType == -1) {
@@ -584,6 +660,7 @@ KTextEditor::Range KateBuffer::computeFoldingRangeForStartLine(int startLine)
     int countOfOpenRegions = 1;
     for (int line = startLine + 1; line < lines(); ++line) {
         // search for matching end marker
+        dependsOnLine = line;
         const auto lineAttributes = computeFoldings(line);
         for (size_t i = 0; i < lineAttributes.size(); ++i) {
             // matching folding close?
@@ -612,7 +689,131 @@ KTextEditor::Range KateBuffer::computeFoldingRangeForStartLine(int startLine)
     }
 
     // if we arrive here, the opened range spans to the end of the document!
+    dependsOnLine = lines() - 1;
     return KTextEditor::Range(KTextEditor::Cursor(startLine, openedRegionOffset), KTextEditor::Cursor(lines() - 1, plainLine(lines() - 1).length()));
 }
 
+std::vector<std::pair<KTextEditor::Range, bool>> KateBuffer::computeFoldingRanges()
+{
+    // no highlighting, no folding, ATM
+    std::vector<std::pair<KTextEditor::Range, bool>> ranges;
+    if (!m_highlight || m_highlight->noHighlighting()) {
+        return ranges;
+    }
+
+    // highlight everything once, below we only redo the lines with folding markers
+    ensureHighlighted(lines() - 1, 0);
+
+    // token based folding: running level per region type and the start lines waiting for their end
+    // a start line ends once the level drops below the level it had at the end of the start line
+    struct OpenRegion {
+        int line;
+        int offset;
+        int closingLevel;
+    };
+    QHash<int, int> regionLevels;
+    QHash<int, std::vector<OpenRegion>> openRegions;
+
+    // indentation based folding: start lines waiting for their end, with increasing indentation
+    struct IndentedLine {
+        int line;
+        int indentation;
+    };
+    std::vector<IndentedLine> indentedLines;
+    const bool indentationSensitive = m_highlight->foldingIndentationSensitive() && (tabWidth() > 0);
+    int lastNonEmptyLine = -1;
+
+    // end all indentation based foldings with at least the given indentation at the last non-empty line
+    const auto closeIndentedLines = [&](int indentation) {
+        while (!indentedLines.empty() && indentedLines.back().indentation >= indentation) {
+            const int startLine = indentedLines.back().line;
+            indentedLines.pop_back();
+
+            // we shall not fold one-liners
+            if (lastNonEmptyLine > startLine) {
+                ranges.emplace_back(KTextEditor::Range(KTextEditor::Cursor(startLine, 0), KTextEditor::Cursor(lastNonEmptyLine, plainLine(lastNonEmptyLine).length())),
+                                    true);
+            }
+        }
+    };
+
+    for (int line = 0; line < lines(); ++line) {
+        const auto textLine = plainLine(line);
+
+        // only lines with unbalanced folding markers can start or end a region spanning multiple lines
+        if (textLine.markedAsFoldingStartAttribute() || textLine.markedAsFoldingEndAttribute()) {
+            const auto foldings = computeFoldings(line);
+            for (const auto &folding : foldings) {
+                const int type = folding.foldingRegion.id();
+                if (folding.foldingRegion.type() == KSyntaxHighlighting::FoldingRegion::Begin) {
+                    ++regionLevels[type];
+                    continue;
+                }
+
+                // folding close, end all start lines waiting for this level
+                const int level = --regionLevels[type];
+                const auto pending = openRegions.find(type);
+                if (pending == openRegions.end()) {
+                    continue;
+                }
+                while (!pending->empty() && pending->back().closingLevel == level) {
+                    const OpenRegion region = pending->back();
+                    pending->pop_back();
+
+                    // Don't return a valid range without content!
+                    if (line - region.line > 1) {
+                        ranges.emplace_back(KTextEditor::Range(KTextEditor::Cursor(region.line, region.offset), KTextEditor::Cursor(line, folding.offset)),
+                                            false);
+                    }
+                }
+            }
+
+            // we prefer token based folding, such a line is no indentation based folding start
+            if (textLine.markedAsFoldingStartAttribute()) {
+                const auto [type, offset] = openedFoldingRegion(foldings);
+                if (type != -1) {
+                    openRegions[type].push_back({line, offset, regionLevels.value(type) - 1});
+                }
+            }
+        }
+
+        // check for indentation based folding
+        if (!indentationSensitive || m_highlight->isEmptyLine(&textLine)) {
+            continue;
+        }
+
+        // the previous non-empty line is no folding start if it is too far away
+        if (!indentedLines.empty() && indentedLines.back().line == lastNonEmptyLine && (line - lastNonEmptyLine - 1) > foldingLookAheadLimit) {
+            indentedLines.pop_back();
+        }
+
+        // end all foldings not indented deeper than this line
+        const int indentation = textLine.indentDepth(tabWidth());
+        closeIndentedLines(indentation);
+        lastNonEmptyLine = line;
+
+        // this line might start a folding, decided by the next non-empty line
+        if (!textLine.markedAsFoldingStartAttribute() && textLine.highlightingState().indentationBasedFoldingEnabled()) {
+            indentedLines.push_back({line, indentation});
+        }
+    }
+
+    // remaining indentation based foldings end at the last non-empty line
+    closeIndentedLines(std::numeric_limits<int>::min());
+
+    // remaining token based foldings span to the end of the document!
+    const KTextEditor::Cursor documentEnd(lines() - 1, plainLine(lines() - 1).length());
+    for (const auto &pending : std::as_const(openRegions)) {
+        for (const OpenRegion &region : pending) {
+            ranges.emplace_back(KTextEditor::Range(KTextEditor::Cursor(region.line, region.offset), documentEnd), false);
+        }
+    }
+
+    // sort by start, each line starts at most one folding
+    std::sort(ranges.begin(), ranges.end(), [](const auto &a, const auto &b) {
+        return a.first.start() < b.first.start();
+    });
+    return ranges;
+}
+
 #include "moc_katebuffer.cpp"
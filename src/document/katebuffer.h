@@ -13,6 +13,7 @@
 
 #include <ktexteditor_export.h>
 
+#include <QHash>
 #include <QObject>
 
 class KateLineInfo;
@@ -182,6 +183,15 @@ public:
      */
     void ensureHighlighted(int line, int lookAhead = 64);
 
+    /**
+     * Update highlighting of given line @p line changed in the running editing transaction.
+     * For code that reads the attributes of lines it changed before the transaction ends.
+     * If the context at the end of the line changed, the following lines are highlighted
+     * again once they are asked for.
+     * @param line changed line
+     */
+    void rehighlightLine(int line);
+
     /**
      * Unwrap given line.
      * @param line line to unwrap
@@ -243,7 +253,32 @@ public:
      */
     KTextEditor::Range computeFoldingRangeForStartLine(int startLine);
 
+    /**
+     * Compute the folding ranges of all lines in one sweep over the buffer.
+     * Yields the same ranges as computeFoldingRangeForStartLine for each line,
+     * but highlights each line at most once, to be used to fold everything at once
+     * @return folding ranges sorted by start, each with the flag if it is indentation based
+     */
+    std::vector<std::pair<KTextEditor::Range, bool>> computeFoldingRanges();
+
 private:
+    /**
+     * Compute the folding range starting at the given line, without using the folding cache.
+     * @param startLine start line, must be a folding start
+     * @param foldingIndentationSensitive is this an indentation based folding start?
+     * @param dependsOnLine set to the last line that was looked at, the result can only change with changes up to that line
+     * @return folding range starting at the given line or invalid range
+     */
+    KTEXTEDITOR_NO_EXPORT
+    KTextEditor::Range computeFoldingRange(int startLine, bool foldingIndentationSensitive, int &dependsOnLine);
+
+    /**
+     * Forget all cached folding information that depends on the given line or later ones.
+     * @param line first changed line
+     */
+    KTEXTEDITOR_NO_EXPORT
+    void invalidateFoldingCache(int line);
+
     /**
      * Highlight information needs to be updated.
      *
@@ -295,6 +330,26 @@ private:
      * last line with valid highlighting
      */
     int m_lineHighlighted;
+
+    /**
+     * Folding information of one start line, see isFoldingStartingOnLine and computeFoldingRangeForStartLine.
+     */
+    struct FoldingCacheEntry {
+        std::pair<bool, bool> start;
+        KTextEditor::Range range = KTextEditor::Range::invalid();
+        bool rangeComputed = false;
+
+        /**
+         * last line the information depends on, it stays valid until this or an earlier line changes
+         */
+        int lastLine = -1;
+    };
+
+    /**
+     * start line => cached folding information
+     * dropped for changed lines on each highlighting update, avoids scans for the matching end on each query
+     */
+    QHash<int, FoldingCacheEntry> m_foldingCache;
 };
 
 #endif
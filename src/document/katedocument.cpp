@@ -16,6 +16,7 @@
 #include "config.h"
 #include "kateabstractinputmode.h"
 #include "kateautoindent.h"
+#include "katebracketindex.h"
 #include "katebuffer.h"
 #include "katecompletionwidget.h"
 #include "kateconfig.h"
@@ -35,6 +36,7 @@
 #include "kateundomanager.h"
 #include "katevariableexpansionmanager.h"
 #include "kateview.h"
+#include "katewordindex.h"
 #include "printing/kateprinter.h"
 #include "spellcheck/ontheflycheck.h"
 #include "spellcheck/prefixstore.h"
@@ -70,6 +72,7 @@
 #include <QCryptographicHash>
 #include <QFile>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QLocale>
 #include <QMimeDatabase>
 #include <QProcess>
@@ -2328,6 +2331,7 @@ bool KTextEditor::DocumentPrivate::openFile()
     //
     if (success) {
         readVariables();
+        updateDiskFileState();
     }
 
     //
@@ -2535,8 +2539,13 @@ bool KTextEditor::DocumentPrivate::saveFile()
         return false;
     }
 
-    // update the checksum
-    createDigest();
+    // update the checksum, reuse the one computed while writing the file if possible
+    if (const QByteArray &digest = m_buffer->saveDigest(); !digest.isEmpty()) {
+        m_buffer->setDigest(digest);
+        updateDiskFileState();
+    } else {
+        createDigest();
+    }
 
     // add m_file again to dirwatch
     activateDirWatch();
@@ -4499,43 +4508,24 @@ KTextEditor::Range KTextEditor::DocumentPrivate::findMatchingBracket(const KText
         return KTextEditor::Range::invalid();
     }
 
-    const int searchDir = isStartBracket(bracket) ? 1 : -1;
-    uint nesting = 0;
-
-    const int minLine = qMax(range.start().line() - maxLines, 0);
-    const int maxLine = qMin(range.start().line() + maxLines, documentEnd().line());
+    // the index skips all blocks that can't contain the match
+    if (!m_bracketIndex) {
+        m_bracketIndex = std::make_unique<KateBracketIndex>(*m_buffer);
+    }
+    const bool forward = isStartBracket(bracket);
+    const KTextEditor::Cursor match =
+        m_bracketIndex->findMatchingBracket(range.start(), forward ? bracket : opposite, forward ? opposite : bracket, maxLines);
+    if (!match.isValid()) {
+        return KTextEditor::Range::invalid();
+    }
 
     range.setEnd(range.start());
-    KTextEditor::DocumentCursor cursor(this);
-    cursor.setPosition(range.start());
-    int validAttr = kateTextLine(cursor.line()).attribute(cursor.column());
-
-    while (cursor.line() >= minLine && cursor.line() <= maxLine) {
-        if (!cursor.move(searchDir)) {
-            return KTextEditor::Range::invalid();
-        }
-
-        Kate::TextLine textLine = kateTextLine(cursor.line());
-        if (textLine.attribute(cursor.column()) == validAttr) {
-            // Check for match
-            QChar c = textLine.at(cursor.column());
-            if (c == opposite) {
-                if (nesting == 0) {
-                    if (searchDir > 0) { // forward
-                        range.setEnd(cursor.toCursor());
-                    } else {
-                        range.setStart(cursor.toCursor());
-                    }
-                    return range;
-                }
-                nesting--;
-            } else if (c == bracket) {
-                nesting++;
-            }
-        }
+    if (forward) {
+        range.setEnd(match);
+    } else {
+        range.setStart(match);
     }
-
-    return KTextEditor::Range::invalid();
+    return range;
 }
 
 // helper: remove \r and \n from visible document name (bug #170876)
@@ -5492,11 +5482,21 @@ void KTextEditor::DocumentPrivate::slotDelayedHandleModOnHd()
     // compare git hash with the one we have (if we have one)
     const QByteArray oldDigest = checksum();
     if (!oldDigest.isEmpty() && !url().isEmpty() && url().isLocalFile()) {
-        // if current checksum == checksum of new file => unmodified
-        if (m_modOnHdReason != OnDiskDeleted && m_modOnHdReason != OnDiskCreated && createDigest() && oldDigest == checksum()) {
-            m_modOnHd = false;
-            m_modOnHdReason = OnDiskUnmodified;
-            m_prevModOnHdReason = OnDiskUnmodified;
+        if (m_modOnHdReason != OnDiskDeleted && m_modOnHdReason != OnDiskCreated) {
+            // cheap checks first: same size and modification time => unmodified, other size => modified
+            // like git, don't trust modification times too close to the time we looked at the file,
+            // the file might have been changed again within the resolution of the file system time stamps
+            const QFileInfo info(url().toLocalFile());
+            const bool sameSize = info.size() == m_diskFileSize;
+            const bool sameState = sameSize && m_diskFileModified.isValid() && info.lastModified() == m_diskFileModified
+                && m_diskFileModified.secsTo(m_diskFileStateTime) >= 2;
+
+            // else: if current checksum == checksum of new file => unmodified
+            if (sameState || ((sameSize || m_diskFileSize < 0) && createDigest() && oldDigest == checksum())) {
+                m_modOnHd = false;
+                m_modOnHdReason = OnDiskUnmodified;
+                m_prevModOnHdReason = OnDiskUnmodified;
+            }
         }
 
         // if still modified, try to take a look at git
@@ -5555,9 +5555,24 @@ bool KTextEditor::DocumentPrivate::createDigest()
 
     // set new digest
     m_buffer->setDigest(digest);
+    updateDiskFileState();
     return !digest.isEmpty();
 }
 
+void KTextEditor::DocumentPrivate::updateDiskFileState()
+{
+    m_diskFileSize = -1;
+    m_diskFileModified = QDateTime();
+    m_diskFileStateTime = QDateTime::currentDateTimeUtc();
+    if (!checksum().isEmpty() && url().isLocalFile()) {
+        const QFileInfo info(url().toLocalFile());
+        if (info.exists()) {
+            m_diskFileSize = info.size();
+            m_diskFileModified = info.lastModified();
+        }
+    }
+}
+
 QString KTextEditor::DocumentPrivate::reasonedMOHString() const
 {
     // squeeze path
@@ -6278,6 +6293,14 @@ void KTextEditor::DocumentPrivate::clearMisspellingForWord(const QString &word)
     }
 }
 
+KateWordIndex *KTextEditor::DocumentPrivate::wordIndex()
+{
+    if (!m_wordIndex) {
+        m_wordIndex = new KateWordIndex(this);
+    }
+    return m_wordIndex;
+}
+
 void KTextEditor::DocumentPrivate::refreshOnTheFlyCheck(KTextEditor::Range range)
 {
     if (m_onTheFlyChecker) {
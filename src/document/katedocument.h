@@ -10,6 +10,7 @@
 #ifndef _KATE_DOCUMENT_H_
 #define _KATE_DOCUMENT_H_
 
+#include <QDateTime>
 #include <QPointer>
 #include <QStack>
 #include <QTimer>
@@ -51,6 +52,8 @@ class ViewPrivate;
 class KateDocumentConfig;
 class KateHighlighting;
 class KateUndoManager;
+class KateWordIndex;
+class KateBracketIndex;
 class KateOnTheFlyChecker;
 class KateDocumentTest;
 
@@ -737,6 +740,14 @@ private:
 
     QString m_dirWatchFile;
 
+    /**
+     * Size and modification time of the file on disk at the time we computed the digest,
+     * see updateDiskFileState(), plus the time we did look at it
+     */
+    qint64 m_diskFileSize = -1;
+    QDateTime m_diskFileModified;
+    QDateTime m_diskFileStateTime;
+
     /**
      * Make backup copy during saveFile, if configured that way.
      * @return success? else saveFile should return false and not write the file
@@ -1055,6 +1066,12 @@ private:
     bool createDigest();
     // exported for katedocument_test
 
+    /**
+     * Remember size and modification time of the file on disk, matching the current digest.
+     * Allows slotDelayedHandleModOnHd() to skip hashing the file if it is obviously (un)changed.
+     */
+    KTEXTEDITOR_NO_EXPORT void updateDiskFileState();
+
     /**
      * create a string for the modonhd warnings, giving the reason.
      */
@@ -1130,6 +1147,9 @@ private:
     // text buffer
     KateBuffer *const m_buffer;
 
+    // bracket summaries for findMatchingBracket(), created on first use
+    std::unique_ptr<KateBracketIndex> m_bracketIndex;
+
     // indenter
     KateAutoIndent *const m_indenter;
 
@@ -1292,6 +1312,20 @@ public:
     QString dictionaryForMisspelledRange(KTextEditor::Range range) const;
     void clearMisspellingForWord(const QString &word);
 
+    /**
+     * Index of all words in this document, shared by all views, created on first use.
+     * Call KateWordIndex::update() before querying it.
+     */
+    KateWordIndex *wordIndex();
+
+    /**
+     * Was the word index already created?
+     */
+    bool hasWordIndex() const
+    {
+        return m_wordIndex;
+    }
+
 public Q_SLOTS:
     void clearDictionaryRanges();
     void setDictionary(const QString &dict, KTextEditor::Range range, bool blockmode);
@@ -1322,6 +1356,7 @@ public:
 
 protected:
     KateOnTheFlyChecker *m_onTheFlyChecker = nullptr;
+    KateWordIndex *m_wordIndex = nullptr;
     QString m_defaultDictionary;
     QList<QPair<KTextEditor::MovingRange *, QString>> m_dictionaryRanges;
 
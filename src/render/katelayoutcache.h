@@ -11,6 +11,7 @@
 #include <QPair>
 
 #include <ktexteditor/range.h>
+#include <ktexteditor_export.h>
 
 #include "katetextlayout.h"
 
@@ -82,7 +83,7 @@ public:
      * \param virtualLine virtual line number. only needed if you think it may have changed
      *                    (ie. basically internal to KateLayoutCache)
      */
-    KateLineLayout *line(int realLine, int virtualLine = -1);
+    KTEXTEDITOR_EXPORT KateLineLayout *line(int realLine, int virtualLine = -1);
 
     /// Returns the layout describing the text line which is occupied by \p realCursor.
     KateTextLayout textLayout(const KTextEditor::Cursor realCursor);
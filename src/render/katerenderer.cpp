@@ -28,17 +28,23 @@
 #include "katepartdebug.h"
 
 #include <QBrush>
+#include <QGlyphRun>
 #include <QPaintEngine>
 #include <QPainter>
 #include <QPainterPath>
 #include <QRegularExpression>
 #include <QStack>
+#include <QVarLengthArray>
 #include <QtMath> // qCeil
 
 static const QChar tabChar(QLatin1Char('\t'));
 static const QChar spaceChar(QLatin1Char(' '));
 static const QChar nbSpaceChar(0xa0); // non-breaking space
 
+// lines longer than this are painted piecewise if not wrapped, see paintVisibleTextSlice
+static constexpr int s_longLineLength = 4096;
+static constexpr int s_longLineColumnMargin = 16;
+
 KateRenderer::KateRenderer(KTextEditor::DocumentPrivate *doc, Kate::TextFolding &folding, KTextEditor::ViewPrivate *view)
     : m_doc(doc)
     , m_folding(folding)
@@ -682,6 +688,162 @@ void KateRenderer::paintTextBackground(QPainter &paint,
     }
 }
 
+// paint the text decorations of a format from x1 to x2 of a line, shifted left by dx, like QTextLayout::draw does
+static void paintTextDecorations(QPainter &paint,
+                                 const QTextCharFormat &format,
+                                 const QFont &font,
+                                 qreal x1,
+                                 qreal x2,
+                                 qreal baseline,
+                                 const QColor &textColor,
+                                 qreal dx)
+{
+    const QFontMetricsF fm(font);
+    QPen pen(textColor, fm.lineWidth());
+    pen.setCapStyle(Qt::FlatCap);
+
+    const QTextCharFormat::UnderlineStyle underlineStyle = format.underlineStyle();
+    if (underlineStyle != QTextCharFormat::NoUnderline) {
+        QPen underlinePen = pen;
+        if (format.underlineColor().isValid()) {
+            underlinePen.setColor(format.underlineColor());
+        }
+        const qreal y = baseline + fm.underlinePos();
+
+        if (underlineStyle == QTextCharFormat::WaveUnderline || underlineStyle == QTextCharFormat::SpellCheckUnderline) {
+            // the wave starts at the line begin, neighboring segments continue it seamlessly
+            const qreal radius = qMax(qreal(1), fm.underlinePos());
+            const qreal period = 2 * qMax(qreal(2), radius * 1.61803399);
+            QPainterPath wave;
+            const qreal waveStart = qFloor(x1 / period) * period;
+            wave.moveTo(waveStart - dx, y);
+            for (qreal x = waveStart - dx; x < x2 - dx; x += period) {
+                wave.quadTo(x + period / 4, y - radius, x + period / 2, y);
+                wave.quadTo(x + period * 3 / 4, y + radius, x + period, y);
+            }
+            paint.save();
+            const qreal margin = radius + underlinePen.widthF();
+            paint.setClipRect(QRectF(x1 - dx, y - margin, x2 - x1, 2 * margin), Qt::IntersectClip);
+            paint.setPen(underlinePen);
+            paint.setBrush(Qt::NoBrush);
+            paint.drawPath(wave);
+            paint.restore();
+        } else {
+            switch (underlineStyle) {
+            case QTextCharFormat::DashUnderline:
+                underlinePen.setStyle(Qt::DashLine);
+                break;
+            case QTextCharFormat::DotLine:
+                underlinePen.setStyle(Qt::DotLine);
+                break;
+            case QTextCharFormat::DashDotLine:
+                underlinePen.setStyle(Qt::DashDotLine);
+                break;
+            case QTextCharFormat::DashDotDotLine:
+                underlinePen.setStyle(Qt::DashDotDotLine);
+                break;
+            default:
+                break;
+            }
+            paint.setPen(underlinePen);
+            paint.drawLine(QLineF(x1 - dx, y, x2 - dx, y));
+        }
+    }
+
+    paint.setPen(pen);
+    if (format.fontStrikeOut()) {
+        const qreal y = baseline - fm.strikeOutPos();
+        paint.drawLine(QLineF(x1 - dx, y, x2 - dx, y));
+    }
+    if (format.fontOverline()) {
+        const qreal y = baseline - fm.overlinePos();
+        paint.drawLine(QLineF(x1 - dx, y, x2 - dx, y));
+    }
+}
+
+void KateRenderer::paintVisibleTextSlice(QPainter &paint,
+                                         KateLineLayout *range,
+                                         int xStart,
+                                         int xEnd,
+                                         const QList<QTextLayout::FormatRange> &additionalFormats) const
+{
+    const QTextLine line = range->layout().lineAt(0);
+
+    // visible columns, with some margin for glyphs reaching over the borders
+    const int startColumn = qMax(0, line.xToCursor(xStart) - s_longLineColumnMargin);
+    const int endColumn = qMin(range->length(), line.xToCursor(xEnd) + s_longLineColumnMargin);
+    if (startColumn >= endColumn) {
+        return;
+    }
+
+    // resolve the format to use for each visible column, later formats win like in QTextLayout::draw
+    const QList<QTextLayout::FormatRange> formats = range->layout().formats();
+    QVarLengthArray<int, 512> formatForColumn(endColumn - startColumn);
+    std::fill(formatForColumn.begin(), formatForColumn.end(), -1);
+    auto assignFormats = [&](const QList<QTextLayout::FormatRange> &ranges, int indexOffset) {
+        for (int i = 0; i < ranges.size(); ++i) {
+            const int start = qMax(ranges[i].start, startColumn);
+            const int end = qMin(ranges[i].start + ranges[i].length, endColumn);
+            for (int column = start; column < end; ++column) {
+                formatForColumn[column - startColumn] = indexOffset + i;
+            }
+        }
+    };
+    assignFormats(formats, 0);
+    assignFormats(additionalFormats, formats.size());
+
+    const QColor normalColor = attribute(KSyntaxHighlighting::Theme::TextStyle::Normal)->foreground().color();
+    const QPointF offset(-xStart, 0);
+
+    // paint the segments of equal format, backgrounds first, glyphs afterwards
+    for (const bool paintBackground : {true, false}) {
+        int segmentStart = startColumn;
+        while (segmentStart < endColumn) {
+            const int formatIndex = formatForColumn[segmentStart - startColumn];
+            int segmentEnd = segmentStart + 1;
+            while (segmentEnd < endColumn && formatForColumn[segmentEnd - startColumn] == formatIndex) {
+                ++segmentEnd;
+            }
+
+            QTextCharFormat format;
+            if (formatIndex >= formats.size()) {
+                format = additionalFormats[formatIndex - formats.size()].format;
+            } else if (formatIndex >= 0) {
+                format = formats[formatIndex].format;
+            }
+
+            if (paintBackground) {
+                if (format.background().style() != Qt::NoBrush) {
+                    const qreal startX = line.cursorToX(segmentStart);
+                    const qreal endX = line.cursorToX(segmentEnd);
+                    paint.fillRect(QRectF(startX - xStart, line.y(), endX - startX, lineHeight()), format.background());
+                }
+            } else {
+                // a pen with the brush keeps gradients and textures
+                paint.setPen(format.hasProperty(QTextFormat::ForegroundBrush) ? QPen(format.foreground(), 0) : QPen(normalColor));
+                const auto glyphRuns = line.glyphRuns(segmentStart, segmentEnd - segmentStart);
+                for (const QGlyphRun &glyphRun : glyphRuns) {
+                    paint.drawGlyphRun(offset, glyphRun);
+                }
+
+                // underlines (e.g. misspellings), strike outs and overlines
+                if (format.underlineStyle() != QTextCharFormat::NoUnderline || format.fontStrikeOut() || format.fontOverline()) {
+                    paintTextDecorations(paint,
+                                         format,
+                                         format.font().resolve(range->layout().font()),
+                                         line.cursorToX(segmentStart),
+                                         line.cursorToX(segmentEnd),
+                                         line.y() + line.ascent(),
+                                         paint.pen().color(),
+                                         xStart);
+                }
+            }
+
+            segmentStart = segmentEnd;
+        }
+    }
+}
+
 void KateRenderer::paintTextLine(QPainter &paint,
                                  KateLineLayout *range,
                                  int xStart,
@@ -766,14 +928,23 @@ void KateRenderer::paintTextLine(QPainter &paint,
                 paintTextBackground(paint, range, decos, Qt::NoBrush, xStart);
             }
 
+            // for very long unwrapped lines only paint the visible part, QTextLayout::draw would walk the whole line
+            const bool paintVisibleSliceOnly = !isPrinterFriendly() && range->length() > s_longLineLength && range->viewLineCount() == 1
+                && range->layout().textOption().textDirection() == Qt::LeftToRight;
+
             if (drawSelection) {
                 additionalFormats = decorationsForLine(range->textLine(), range->line(), true);
                 if (hasCustomLineHeight()) {
                     paintTextBackground(paint, range, additionalFormats, config()->selectionColor(), xStart);
                 }
-                // DONT apply clipping, it breaks rendering when there are selections
-                range->layout().draw(&paint, QPoint(-xStart, 0), additionalFormats);
-
+                if (paintVisibleSliceOnly) {
+                    paintVisibleTextSlice(paint, range, xStart, xEnd, additionalFormats);
+                } else {
+                    // DONT apply clipping, it breaks rendering when there are selections
+                    range->layout().draw(&paint, QPoint(-xStart, 0), additionalFormats);
+                }
+            } else if (paintVisibleSliceOnly) {
+                paintVisibleTextSlice(paint, range, xStart, xEnd, additionalFormats);
             } else {
                 range->layout().draw(&paint, QPoint(-xStart, 0), QList<QTextLayout::FormatRange>{}, textClipRect);
             }
@@ -383,6 +383,20 @@ public:
 
     void paintTextBackground(QPainter &paint, KateLineLayout *layout, const QList<QTextLayout::FormatRange> &selRanges, const QBrush &br, int xStart) const;
 
+    /**
+     * Paint the text of a very long, not wrapped line.
+     * Only the glyphs between @p xStart and @p xEnd are drawn, split into runs of the same format,
+     * with their backgrounds and text decorations, instead of letting QTextLayout::draw iterate
+     * over all items of the line. The line is still laid out as a whole.
+     *
+     * @param paint             painter to use
+     * @param range             layout of the line, must consist of one view line
+     * @param xStart            starting width in pixels.
+     * @param xEnd              ending width in pixels.
+     * @param additionalFormats formats drawn on top of the layout formats, e.g. the selection
+     */
+    void paintVisibleTextSlice(QPainter &paint, KateLineLayout *range, int xStart, int xEnd, const QList<QTextLayout::FormatRange> &additionalFormats) const;
+
     /**
      * This takes an in index, and returns all the attributes for it.
      * For example, if you have a ktextline, and want the KTextEditor::Attribute
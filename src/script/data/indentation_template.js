@@ -49,4 +49,20 @@ function indent(line, indentWidth, ch)
     return -2;
 }
 
+/**
+ * Indent the lines from startLine to endLine (optional).
+ * This function is called for the action "Tools > Align" and for pasted
+ * text, if it is missing, indent(line, indentWidth, "") is called for each
+ * line instead. Define it if the indenter can do a range of lines faster.
+ *
+ * Pass the indentation of each line to applyIndent(line, result), with
+ * the same meaning as the return value of indent(). The line is changed
+ * right away, the following lines can rely on its new indentation.
+ */
+// function indentLines(startLine, endLine, indentWidth, applyIndent)
+// {
+//     for (var line = startLine; line <= endLine; ++line)
+//         applyIndent(line, indent(line, indentWidth, ""));
+// }
+
 // kate: space-indent on; indent-width 4; replace-tabs on;
@@ -9,6 +9,51 @@
 
 #include <QJSEngine>
 #include <QJSValue>
+#include <QObject>
+
+/**
+ * Receives the indentation of the lines from the script, see KateIndentScript::indentLines().
+ */
+class KateIndentScriptReceiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit KateIndentScriptReceiver(const std::function<void(int, QPair<int, int>)> &applyIndent)
+        : m_applyIndent(applyIndent)
+    {
+    }
+
+    /**
+     * Apply the indentation of the given line, @p result is a return value of indent().
+     */
+    Q_INVOKABLE void indented(int line, const QJSValue &result);
+
+private:
+    const std::function<void(int, QPair<int, int>)> &m_applyIndent;
+};
+
+/**
+ * Convert the return value of indent() into the indent amount and the alignment.
+ */
+static QPair<int, int> indentFromResult(const QJSValue &result)
+{
+    int indentAmount = -2;
+    int alignAmount = -2;
+    if (result.isArray()) {
+        indentAmount = result.property(0).toInt();
+        alignAmount = result.property(1).toInt();
+    } else {
+        indentAmount = result.toInt();
+    }
+
+    return qMakePair(indentAmount, alignAmount);
+}
+
+void KateIndentScriptReceiver::indented(int line, const QJSValue &result)
+{
+    m_applyIndent(line, indentFromResult(result));
+}
 
 KateIndentScript::KateIndentScript(const QString &url, const KateIndentScriptHeader &header)
     : KateScript(url)
@@ -64,14 +109,58 @@ QPair<int, int> KateIndentScript::indent(KTextEditor::ViewPrivate *view, const K
         displayBacktrace(result, QStringLiteral("Error calling indent()"));
         return qMakePair(-2, -2);
     }
-    int indentAmount = -2;
-    int alignAmount = -2;
-    if (result.isArray()) {
-        indentAmount = result.property(0).toInt();
-        alignAmount = result.property(1).toInt();
-    } else {
-        indentAmount = result.toInt();
+
+    return indentFromResult(result);
+}
+
+bool KateIndentScript::indentLines(KTextEditor::ViewPrivate *view,
+                                   int startLine,
+                                   int endLine,
+                                   int indentWidth,
+                                   const std::function<void(int, QPair<int, int>)> &applyIndent)
+{
+    // if it hasn't loaded or we can't load, return
+    if (!setView(view)) {
+        return false;
     }
 
-    return qMakePair(indentAmount, alignAmount);
+    clearExceptions();
+    if (!function(QStringLiteral("indent")).isCallable()) {
+        return false;
+    }
+
+    // the loop over the lines runs inside the engine, one call instead of one per line
+    if (m_indentLinesFunction.isUndefined()) {
+        m_indentLinesFunction = m_engine->evaluate(
+            QStringLiteral("(function(startLine, endLine, indentWidth, receiver) {\n"
+                           "    var applyIndent = function(line, result) { receiver.indented(line, result); };\n"
+                           "    if (typeof indentLines === \"function\") {\n"
+                           "        indentLines(startLine, endLine, indentWidth, applyIndent);\n"
+                           "        return;\n"
+                           "    }\n"
+                           "    for (var line = startLine; line <= endLine; ++line) {\n"
+                           "        applyIndent(line, indent(line, indentWidth, \"\"));\n"
+                           "    }\n"
+                           "})"));
+    }
+
+    // the receiver lives on the stack, the engine must not garbage collect it
+    KateIndentScriptReceiver receiver(applyIndent);
+    QJSEngine::setObjectOwnership(&receiver, QJSEngine::CppOwnership);
+
+    QJSValueList arguments;
+    arguments << QJSValue(startLine);
+    arguments << QJSValue(endLine);
+    arguments << QJSValue(indentWidth);
+    arguments << m_engine->newQObject(&receiver);
+    QJSValue result = m_indentLinesFunction.call(arguments);
+    // error during the calling?
+    if (result.isError()) {
+        displayBacktrace(result, QStringLiteral("Error calling indentLines()"));
+        return false;
+    }
+
+    return true;
 }
+
+#include "kateindentscript.moc"
@@ -12,6 +12,8 @@
 
 #include <KTextEditor/Cursor>
 
+#include <functional>
+
 namespace KTextEditor
 {
 class ViewPrivate;
@@ -113,10 +115,24 @@ public:
      */
     QPair<int, int> indent(KTextEditor::ViewPrivate *view, const KTextEditor::Cursor position, QChar typedCharacter, int indentWidth);
 
+    /**
+     * Indent all lines from @p startLine to @p endLine with a single call into the script.
+     * Calls the indentLines() function of the script if it has one, otherwise indent() for each line.
+     * The indentation of each line is passed to @p applyIndent right away, as the indentation of
+     * the following lines depends on it. The pair has the same meaning as the result of indent().
+     * @return false if the script could not be called
+     */
+    bool indentLines(KTextEditor::ViewPrivate *view, int startLine, int endLine, int indentWidth, const std::function<void(int, QPair<int, int>)> &applyIndent);
+
 private:
     QString m_triggerCharacters;
     bool m_triggerCharactersSet = false;
     KateIndentScriptHeader m_indentHeader;
+
+    /**
+     * JavaScript function doing the loop of indentLines(), compiled on first use
+     */
+    QJSValue m_indentLinesFunction;
 };
 
 #endif
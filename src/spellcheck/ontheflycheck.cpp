@@ -348,24 +348,45 @@ void KateOnTheFlyChecker::performSpellCheck()
         ON_THE_FLY_DEBUG << "exited as there is nothing to do";
         return;
     }
-    m_currentlyCheckedItem = m_spellCheckQueue.takeFirst();
 
-    KTextEditor::MovingRange *spellCheckRange = m_currentlyCheckedItem.first;
-    const QString &language = m_currentlyCheckedItem.second;
-    ON_THE_FLY_DEBUG << "for the range " << *spellCheckRange;
-    // clear all the highlights that are currently present in the range that
-    // is supposed to be checked
-    const MovingRangeList highlightsList = installedMovingRanges(*spellCheckRange); // make a copy!
-    deleteMovingRanges(highlightsList);
+    // texts checked before are handled right away, only unknown ones are passed to Sonnet
+    KateSpellCheckManager *spellCheckManager = KTextEditor::EditorPrivate::self()->spellCheckManager();
+    while (!m_spellCheckQueue.isEmpty()) {
+        m_currentlyCheckedItem = m_spellCheckQueue.takeFirst();
 
-    m_currentDecToEncOffsetList.clear();
-    KTextEditor::DocumentPrivate::OffsetList encToDecOffsetList;
-    QString text = m_document->decodeCharacters(*spellCheckRange, m_currentDecToEncOffsetList, encToDecOffsetList);
-    ON_THE_FLY_DEBUG << "next spell checking" << text;
-    if (text.isEmpty()) { // passing an empty string to Sonnet can lead to a bad allocation exception
-        spellCheckDone(); // (bug 225867)
+        KTextEditor::MovingRange *spellCheckRange = m_currentlyCheckedItem.first;
+        const QString &language = m_currentlyCheckedItem.second;
+        ON_THE_FLY_DEBUG << "for the range " << *spellCheckRange;
+        // clear all the highlights that are currently present in the range that
+        // is supposed to be checked
+        const MovingRangeList highlightsList = installedMovingRanges(*spellCheckRange); // make a copy!
+        deleteMovingRanges(highlightsList);
+
+        m_currentDecToEncOffsetList.clear();
+        KTextEditor::DocumentPrivate::OffsetList encToDecOffsetList;
+        m_currentlyCheckedText = m_document->decodeCharacters(*spellCheckRange, m_currentDecToEncOffsetList, encToDecOffsetList);
+        ON_THE_FLY_DEBUG << "next spell checking" << m_currentlyCheckedText;
+        if (m_currentlyCheckedText.isEmpty()) { // passing an empty string to Sonnet can lead to a bad allocation exception
+            finishCurrentSpellCheck(); // (bug 225867)
+            continue;
+        }
+
+        const auto misspellings = spellCheckManager->cachedMisspellings(m_currentlyCheckedText, language);
+        if (!misspellings) {
+            break;
+        }
+        for (const auto &[word, start] : *misspellings) {
+            addMisspelledRange(word, start);
+        }
+        finishCurrentSpellCheck();
+    }
+
+    // everything was known
+    if (m_currentlyCheckedItem == invalidSpellCheckQueueItem()) {
         return;
     }
+
+    const QString &language = m_currentlyCheckedItem.second;
     if (m_speller.language() != language) {
         m_speller.setLanguage(language);
     }
@@ -374,12 +395,12 @@ void KateOnTheFlyChecker::performSpellCheck()
         connect(m_backgroundChecker, &Sonnet::BackgroundChecker::misspelling, this, &KateOnTheFlyChecker::misspelling);
         connect(m_backgroundChecker, &Sonnet::BackgroundChecker::done, this, &KateOnTheFlyChecker::spellCheckDone);
 
-        KateSpellCheckManager *m_spellCheckManager = KTextEditor::EditorPrivate::self()->spellCheckManager();
-        connect(m_spellCheckManager, &KateSpellCheckManager::wordAddedToDictionary, this, &KateOnTheFlyChecker::addToDictionary);
-        connect(m_spellCheckManager, &KateSpellCheckManager::wordIgnored, this, &KateOnTheFlyChecker::addToSession);
+        connect(spellCheckManager, &KateSpellCheckManager::wordAddedToDictionary, this, &KateOnTheFlyChecker::addToDictionary);
+        connect(spellCheckManager, &KateSpellCheckManager::wordIgnored, this, &KateOnTheFlyChecker::addToSession);
     }
     m_backgroundChecker->setSpeller(m_speller);
-    m_backgroundChecker->setText(text); // don't call 'start()' after this!
+    m_currentDictionaryGeneration = spellCheckManager->dictionaryGeneration(language);
+    m_backgroundChecker->setText(m_currentlyCheckedText); // don't call 'start()' after this!
 }
 
 void KateOnTheFlyChecker::addToDictionary(const QString &word)
@@ -433,11 +454,23 @@ void KateOnTheFlyChecker::stopCurrentSpellCheck()
 {
     m_currentDecToEncOffsetList.clear();
     m_currentlyCheckedItem = invalidSpellCheckQueueItem();
+    m_currentlyCheckedText.clear();
+    m_currentMisspellings.clear();
     if (m_backgroundChecker) {
         m_backgroundChecker->stop();
     }
 }
 
+void KateOnTheFlyChecker::finishCurrentSpellCheck()
+{
+    KTextEditor::MovingRange *movingRange = m_currentlyCheckedItem.first;
+    m_currentDecToEncOffsetList.clear();
+    m_currentlyCheckedItem = invalidSpellCheckQueueItem();
+    m_currentlyCheckedText.clear();
+    m_currentMisspellings.clear();
+    deleteMovingRangeQuickly(movingRange);
+}
+
 bool KateOnTheFlyChecker::removeRangeFromSpellCheckQueue(KTextEditor::MovingRange *range)
 {
     if (removeRangeFromCurrentSpellCheck(range)) {
@@ -562,12 +595,22 @@ void KateOnTheFlyChecker::misspelling(const QString &word, int start)
         ON_THE_FLY_DEBUG << "exited as no spell check is taking place";
         return;
     }
-    int translatedStart = m_document->computePositionWrtOffsets(m_currentDecToEncOffsetList, start);
     //   ON_THE_FLY_DEBUG << "misspelled " << word
     //                                     << " at line "
     //                                     << *m_currentlyCheckedItem.first
     //                                     << " column " << start;
 
+    addMisspelledRange(word, start);
+    m_currentMisspellings.push_back(qMakePair(word, start));
+
+    if (m_backgroundChecker) {
+        m_backgroundChecker->continueChecking();
+    }
+}
+
+void KateOnTheFlyChecker::addMisspelledRange(const QString &word, int start)
+{
+    int translatedStart = m_document->computePositionWrtOffsets(m_currentDecToEncOffsetList, start);
     KTextEditor::MovingRange *spellCheckRange = m_currentlyCheckedItem.first;
     int line = spellCheckRange->start().line();
     int rangeStart = spellCheckRange->start().column();
@@ -585,10 +628,6 @@ void KateOnTheFlyChecker::misspelling(const QString &word, int start)
 
     movingRange->setAttribute(KTextEditor::Attribute::Ptr(attribute));
     m_misspelledList.push_back(MisspelledItem(movingRange, m_currentlyCheckedItem.second));
-
-    if (m_backgroundChecker) {
-        m_backgroundChecker->continueChecking();
-    }
 }
 
 void KateOnTheFlyChecker::spellCheckDone()
@@ -597,6 +636,15 @@ void KateOnTheFlyChecker::spellCheckDone()
     if (m_currentlyCheckedItem == invalidSpellCheckQueueItem()) {
         return;
     }
+
+    // remember the result, the same text is checked again e.g. after scrolling or rehighlighting
+    // unless a word was ignored or added to the dictionary meanwhile, then the result may be stale
+    KateSpellCheckManager *spellCheckManager = KTextEditor::EditorPrivate::self()->spellCheckManager();
+    const QString &language = m_currentlyCheckedItem.second;
+    if (spellCheckManager->dictionaryGeneration(language) == m_currentDictionaryGeneration) {
+        spellCheckManager->cacheMisspellings(m_currentlyCheckedText, language, m_currentMisspellings);
+    }
+
     KTextEditor::MovingRange *movingRange = m_currentlyCheckedItem.first;
     stopCurrentSpellCheck();
     deleteMovingRangeQuickly(movingRange);
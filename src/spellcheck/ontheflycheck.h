@@ -18,6 +18,7 @@
 #include <sonnet/speller.h>
 
 #include "katedocument.h"
+#include "spellcheck.h"
 
 namespace Sonnet
 {
@@ -64,6 +65,9 @@ protected:
     QList<SpellCheckItem> m_spellCheckQueue;
     Sonnet::BackgroundChecker *m_backgroundChecker;
     SpellCheckItem m_currentlyCheckedItem;
+    QString m_currentlyCheckedText;
+    quint64 m_currentDictionaryGeneration = 0;
+    KateSpellCheckManager::Misspellings m_currentMisspellings;
     MisspelledList m_misspelledList;
     ModificationList m_modificationList;
     KTextEditor::DocumentPrivate::OffsetList m_currentDecToEncOffsetList;
@@ -99,12 +103,14 @@ protected:
     void deleteMovingRanges(const QList<KTextEditor::MovingRange *> &list);
     void deleteMovingRangeQuickly(KTextEditor::MovingRange *range);
     void stopCurrentSpellCheck();
+    void finishCurrentSpellCheck();
 
 protected:
     void performSpellCheck();
     void addToDictionary(const QString &word);
     void addToSession(const QString &word);
     void misspelling(const QString &word, int start);
+    void addMisspelledRange(const QString &word, int start);
     void spellCheckDone();
 
     void viewDestroyed(QObject *obj);
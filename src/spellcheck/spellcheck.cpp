@@ -35,6 +35,8 @@ void KateSpellCheckManager::ignoreWord(const QString &word, const QString &dicti
     Sonnet::Speller speller;
     speller.setLanguage(dictionary);
     speller.addToSession(word);
+    m_misspellingsCache.erase(dictionary);
+    ++m_dictionaryGenerations[dictionary];
     Q_EMIT wordIgnored(word);
 }
 
@@ -43,9 +45,40 @@ void KateSpellCheckManager::addToDictionary(const QString &word, const QString &
     Sonnet::Speller speller;
     speller.setLanguage(dictionary);
     speller.addToPersonal(word);
+    m_misspellingsCache.erase(dictionary);
+    ++m_dictionaryGenerations[dictionary];
     Q_EMIT wordAddedToDictionary(word);
 }
 
+void KateSpellCheckManager::settingsChanged()
+{
+    m_misspellingsCache.clear();
+    ++m_settingsGeneration;
+}
+
+std::optional<KateSpellCheckManager::Misspellings> KateSpellCheckManager::cachedMisspellings(const QString &text, const QString &dictionary)
+{
+    const auto cache = m_misspellingsCache.find(dictionary);
+    if (cache == m_misspellingsCache.end()) {
+        return std::nullopt;
+    }
+
+    // marks the text as recently used
+    const Misspellings *misspellings = cache->second.object(text);
+    if (!misspellings) {
+        return std::nullopt;
+    }
+    return *misspellings;
+}
+
+void KateSpellCheckManager::cacheMisspellings(const QString &text, const QString &dictionary, const Misspellings &misspellings)
+{
+    // limit the cached text per dictionary, most checked texts are line parts
+    constexpr qsizetype maxCachedCharacters = 1024 * 1024;
+    auto cache = m_misspellingsCache.try_emplace(dictionary, maxCachedCharacters).first;
+    cache->second.insert(text, new Misspellings(misspellings), text.size() + 1);
+}
+
 QList<KTextEditor::Range> KateSpellCheckManager::rangeDifference(KTextEditor::Range r1, KTextEditor::Range r2)
 {
     Q_ASSERT(r1.contains(r2));
@@ -7,21 +7,27 @@
 #ifndef SPELLCHECK_H
 #define SPELLCHECK_H
 
+#include <QCache>
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QPair>
 #include <QString>
 
 #include <ktexteditor/document.h>
+#include <ktexteditor_export.h>
 #include <sonnet/backgroundchecker.h>
 #include <sonnet/speller.h>
 
+#include <map>
+#include <optional>
+
 namespace KTextEditor
 {
 class DocumentPrivate;
 }
 
-class KateSpellCheckManager : public QObject
+class KTEXTEDITOR_EXPORT KateSpellCheckManager : public QObject
 {
     Q_OBJECT
 
@@ -31,6 +37,11 @@ public:
     explicit KateSpellCheckManager(QObject *parent = nullptr);
     ~KateSpellCheckManager() override;
 
+    /**
+     * Misspelled words of a text with their offsets
+     */
+    typedef QList<QPair<QString, int>> Misspellings;
+
     static QStringList suggestions(const QString &word, const QString &dictionary);
 
     void ignoreWord(const QString &word, const QString &dictionary);
@@ -41,6 +52,33 @@ public:
      **/
     static QList<KTextEditor::Range> rangeDifference(KTextEditor::Range r1, KTextEditor::Range r2);
 
+    /**
+     * Look up the result of an earlier on-the-fly check of the same text with the given dictionary.
+     * @return the misspellings of the text, nothing if it wasn't checked before
+     **/
+    std::optional<Misspellings> cachedMisspellings(const QString &text, const QString &dictionary);
+
+    /**
+     * Remember the result of an on-the-fly check, shared by all documents.
+     * The least recently used texts of a dictionary are dropped first.
+     **/
+    void cacheMisspellings(const QString &text, const QString &dictionary, const Misspellings &misspellings);
+
+    /**
+     * Counts the words ignored or added to the given dictionary and the changes of the Sonnet settings.
+     * A check that saw the generation change while running must not be cached.
+     **/
+    quint64 dictionaryGeneration(const QString &dictionary) const
+    {
+        return m_dictionaryGenerations.value(dictionary) + m_settingsGeneration;
+    }
+
+    /**
+     * The Sonnet settings changed, e.g. skipping of upper case or run-together words.
+     * Drops the cached results of all dictionaries.
+     **/
+    void settingsChanged();
+
 Q_SIGNALS:
     /**
      * These signals are used to propagate the dictionary changes to the
@@ -63,6 +101,22 @@ public:
 
 private:
     static void trimRange(KTextEditor::DocumentPrivate *doc, KTextEditor::Range &r);
+
+    /**
+     * dictionary => checked texts with their misspellings
+     * dropped for a dictionary once a word gets ignored or added to it
+     **/
+    std::map<QString, QCache<QString, Misspellings>> m_misspellingsCache;
+
+    /**
+     * dictionary => number of words ignored or added to it
+     **/
+    QHash<QString, quint64> m_dictionaryGenerations;
+
+    /**
+     * number of Sonnet settings changes, affects all dictionaries
+     **/
+    quint64 m_settingsGeneration = 0;
 };
 
 #endif
@@ -5,14 +5,13 @@
     SPDX-License-Identifier: LGPL-2.0-or-later
 */
 
-#include "config.h"
-
 #include "katebuffer.h"
 #include "kateconfig.h"
 #include "katedocument.h"
 #include "katepartdebug.h"
 #include "kateswapdiffcreator.h"
 #include "kateswapfile.h"
+#include "kateswapfilewriter.h"
 #include "katetextbuffer.h"
 #include "kateundomanager.h"
 #include "ktexteditor/message.h"
@@ -25,22 +24,107 @@
 #include <QCryptographicHash>
 #include <QDir>
 #include <QFileInfo>
+#include <QtEndian>
 
-#ifndef Q_OS_WIN
-#include <unistd.h>
-#endif
+#include <cstring>
+#include <limits>
 
 // swap file version header
-const static char swapFileVersionString[] = "Kate Swap File 2.0";
+const static char swapFileVersionString[] = "Kate Swap File 3.0";
+
+// header of swap files written before the journal format, still recovered
+const static char swapFileVersion2String[] = "Kate Swap File 2.0";
+
+// tokens of version 2 swap files, each operation was written on its own
+const static qint8 EA2_StartEditing = 'S';
+const static qint8 EA2_FinishEditing = 'E';
+
+// record types of the journal, each record is the type followed by a QDataStream byte array
+const static qint8 EA_Transaction = 'T';
+const static qint8 EA_CompressedTransaction = 'Z';
+const static qint8 EA_Checkpoint = 'C';
 
-// tokens for swap files
-const static qint8 EA_StartEditing = 'S';
-const static qint8 EA_FinishEditing = 'E';
+// tokens for the operations inside a transaction, arguments are varint encoded
 const static qint8 EA_WrapLine = 'W';
 const static qint8 EA_UnwrapLine = 'U';
 const static qint8 EA_InsertText = 'I';
 const static qint8 EA_RemoveText = 'R';
 
+// pending records are written after this delay (ms) or once there is this much data (bytes)
+const static int journalCommitInterval = 500;
+const static qsizetype journalCommitSize = 64 * 1024;
+
+// transactions larger than this (bytes) are compressed
+const static qsizetype journalCompressionSize = 512;
+
+// swap files larger than this (bytes) are compacted to a checkpoint of the document text
+const static qint64 journalCompactionSize = 8 * 1024 * 1024;
+
+// maximal length of a varint encoded int
+const static int maxVarintLength = 5;
+
+/**
+ * Encode value as varint to data, returns the number of used bytes.
+ */
+static int encodeVarint(char *data, quint32 value)
+{
+    int length = 0;
+    while (value >= 0x80) {
+        data[length++] = char((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    data[length++] = char(value);
+    return length;
+}
+
+static void appendVarint(QByteArray &data, int value)
+{
+    Q_ASSERT(value >= 0);
+    char buffer[maxVarintLength];
+    data.append(buffer, encodeVarint(buffer, quint32(value)));
+}
+
+/**
+ * Decode varint at pos, advances pos.
+ * @return false on truncated or too large values
+ */
+static bool readVarint(const char *&pos, const char *end, int &value)
+{
+    quint32 result = 0;
+    for (int shift = 0; shift < 7 * maxVarintLength && pos < end; shift += 7) {
+        const quint8 byte = quint8(*pos++);
+        result |= quint32(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            if (result > quint32(std::numeric_limits<int>::max())) {
+                return false;
+            }
+            value = int(result);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Uncompress a record written with qCompress(), it starts with the uncompressed size as 4 byte big endian.
+ * @return false on broken data
+ */
+static bool uncompressRecord(const QByteArray &record, QByteArray &data)
+{
+    if (record.size() < 4) {
+        return false;
+    }
+
+    // empty data is stored as size 0 only, qUncompress() can't tell this from an error
+    if (qFromBigEndian<quint32>(record.constData()) == 0) {
+        data.clear();
+        return true;
+    }
+
+    data = qUncompress(record);
+    return !data.isEmpty();
+}
+
 namespace Kate
 {
 QTimer *SwapFile::s_timer = nullptr;
@@ -51,10 +135,16 @@ SwapFile::SwapFile(KTextEditor::DocumentPrivate *document)
     , m_trackingEnabled(false)
     , m_recovered(false)
     , m_needSync(false)
+    , m_encoder(QStringEncoder::Utf8)
 {
     // fixed version of serialisation
     m_stream.setVersion(QDataStream::Qt_4_6);
 
+    // group commit of the journal
+    m_commitTimer.setSingleShot(true);
+    m_commitTimer.setInterval(journalCommitInterval);
+    connect(&m_commitTimer, &QTimer::timeout, this, &Kate::SwapFile::commitJournal);
+
     // connect the timer
     connect(syncTimer(), &QTimer::timeout, this, &Kate::SwapFile::writeFileToDisk, Qt::DirectConnection);
 
@@ -126,14 +216,19 @@ KTextEditor::DocumentPrivate *SwapFile::document()
     return m_document;
 }
 
-bool SwapFile::isValidSwapFile(QDataStream &stream, bool checkDigest) const
+bool SwapFile::isValidSwapFile(QDataStream &stream, bool checkDigest, int &version) const
 {
     // read and check header
     QByteArray header;
     stream >> header;
 
-    if (header != swapFileVersionString) {
-        qCWarning(LOG_KTE) << "Can't open swap file, wrong version";
+    if (header == swapFileVersionString) {
+        version = 3;
+    } else if (header == swapFileVersion2String) {
+        version = 2;
+    } else {
+        version = 0;
+        qCWarning(LOG_KTE) << "Can't open swap file, unknown version:" << header;
         return false;
     }
 
@@ -156,6 +251,23 @@ void SwapFile::fileLoaded(const QString &)
         return;
     }
 
+    // the writer might still be busy with our old swap file, look once it is done
+    if (m_journalFile || m_pendingRemovals > 0) {
+        SwapFileWriter::self()->notify(this, [this, journal = std::weak_ptr(m_journalFile)]() {
+            // editing started meanwhile, the swap file is our own one
+            if (m_journalFile && m_journalFile != journal.lock()) {
+                return;
+            }
+            checkSwapFile();
+        });
+        return;
+    }
+
+    checkSwapFile();
+}
+
+void SwapFile::checkSwapFile()
+{
     if (!m_swapfile.exists()) {
         // qCDebug(LOG_KTE) << "No swap file";
         return;
@@ -170,7 +282,21 @@ void SwapFile::fileLoaded(const QString &)
     QFile peekFile(fileName());
     if (peekFile.open(QIODevice::ReadOnly)) {
         QDataStream stream(&peekFile);
-        if (!isValidSwapFile(stream, true)) {
+        int version = 0;
+        if (!isValidSwapFile(stream, true, version)) {
+            peekFile.close();
+            if (version == 0) {
+                // maybe written by a newer version, never delete data we can't read
+                const QString backupName = fileName() + QStringLiteral(".unknown");
+                QFile::remove(backupName);
+                if (QFile::rename(fileName(), backupName)) {
+                    qCWarning(LOG_KTE) << "Swap file of unknown version moved to:" << backupName;
+                } else {
+                    qCWarning(LOG_KTE) << "Swap file of unknown version kept, no swap file for this document:" << fileName();
+                    m_swapfile.setFileName(QString());
+                }
+                return;
+            }
             removeSwapFile();
             return;
         }
@@ -202,7 +328,7 @@ void SwapFile::recover()
     // Example: The document was falsely marked as writable and the user changed
     // text even though the recover bar was visible. In this case, a replay of
     // the swap file across wrong document content would happen -> certainly wrong
-    if (m_swapfile.isOpen()) {
+    if (m_journalFile) {
         qCWarning(LOG_KTE) << "Attempt to recover an already modified document. Aborting";
         removeSwapFile();
         return;
@@ -240,166 +366,226 @@ void SwapFile::recover()
 
 bool SwapFile::recover(QDataStream &stream, bool checkDigest)
 {
-    if (!isValidSwapFile(stream, checkDigest)) {
+    int version = 0;
+    if (!isValidSwapFile(stream, checkDigest, version)) {
         return false;
     }
 
     // disconnect current signals
     setTrackingEnabled(false);
 
-    // needed to set undo/redo cursors in a sane way
-    bool firstEditInGroup = false;
-    KTextEditor::Cursor undoCursor = KTextEditor::Cursor::invalid();
-    KTextEditor::Cursor redoCursor = KTextEditor::Cursor::invalid();
+    // replay the whole swapfile as one editing transaction without undo items:
+    // views, highlighting and folding are updated once at the end, not per recorded edit
+    m_document->undoManager()->recoveryStart();
 
-    // replay swapfile
-    bool editRunning = false;
-    bool brokenSwapFile = false;
-    while (!stream.atEnd()) {
-        if (brokenSwapFile) {
+    // last edit position, to set a sane final cursor
+    KTextEditor::Cursor lastCursor = KTextEditor::Cursor::invalid();
+
+    // replay swapfile, one record per editing transaction
+    bool brokenSwapFile = (version == 2) && !replayVersion2(stream, lastCursor);
+    while (version == 3 && !stream.atEnd() && !brokenSwapFile) {
+        qint8 type;
+        QByteArray record;
+        stream >> type >> record;
+
+        // incomplete last record, e.g. crash while writing
+        if (stream.status() != QDataStream::Ok) {
+            brokenSwapFile = true;
+            break;
+        }
+
+        switch (type) {
+        case EA_Transaction: {
+            brokenSwapFile = !replayTransaction(record, lastCursor);
+            break;
+        }
+        case EA_CompressedTransaction: {
+            QByteArray transaction;
+            brokenSwapFile = !uncompressRecord(record, transaction) || !replayTransaction(transaction, lastCursor);
             break;
         }
+        case EA_Checkpoint: {
+            // full text of the document at the time the journal got compacted, might be empty
+            QByteArray text;
+            if (!uncompressRecord(record, text)) {
+                brokenSwapFile = true;
+                break;
+            }
+            m_document->setText(QString::fromUtf8(text));
+            lastCursor = KTextEditor::Cursor::invalid();
+            break;
+        }
+        default: {
+            qCWarning(LOG_KTE) << "Unknown type:" << type;
+            brokenSwapFile = true;
+        }
+        }
+    }
+
+    m_document->undoManager()->recoveryEnd();
+
+    // warn the user if the swap file is not complete
+    if (brokenSwapFile) {
+        qCWarning(LOG_KTE) << "Some data might be lost";
+    } else {
+        // set sane final cursor, if possible
+        KTextEditor::View *view = m_document->activeView();
+        if (view && lastCursor.isValid()) {
+            view->setCursorPosition(lastCursor);
+        }
+    }
+
+    // reconnect the signals
+    setTrackingEnabled(true);
+
+    return true;
+}
 
+bool SwapFile::replayVersion2(QDataStream &stream, KTextEditor::Cursor &lastCursor)
+{
+    // operations are enclosed in start and finish tokens, all arguments are QDataStream ints
+    bool editRunning = false;
+    while (!stream.atEnd()) {
         qint8 type;
         stream >> type;
+        if (type != EA2_StartEditing && !editRunning) {
+            return false;
+        }
+
         switch (type) {
-        case EA_StartEditing: {
-            m_document->editStart();
+        case EA2_StartEditing: {
             editRunning = true;
-            firstEditInGroup = true;
-            undoCursor = KTextEditor::Cursor::invalid();
-            redoCursor = KTextEditor::Cursor::invalid();
             break;
         }
-        case EA_FinishEditing: {
-            m_document->editEnd();
-
-            // empty editStart() / editEnd() groups exist: only set cursor if required
-            if (!firstEditInGroup) {
-                // set undo/redo cursor of last KateUndoGroup of the undo manager
-                m_document->undoManager()->setUndoRedoCursorsOfLastGroup(undoCursor, redoCursor);
-                m_document->undoManager()->undoSafePoint();
-            }
-            firstEditInGroup = false;
+        case EA2_FinishEditing: {
             editRunning = false;
             break;
         }
         case EA_WrapLine: {
-            if (!editRunning) {
-                brokenSwapFile = true;
-                break;
-            }
-
             int line = 0;
             int column = 0;
             stream >> line >> column;
-
-            // emulate buffer unwrapLine with document
-            m_document->editWrapLine(line, column, true);
-
-            // track undo/redo cursor
-            if (firstEditInGroup) {
-                firstEditInGroup = false;
-                undoCursor = KTextEditor::Cursor(line, column);
+            if (stream.status() != QDataStream::Ok) {
+                return false;
             }
-            redoCursor = KTextEditor::Cursor(line + 1, 0);
 
+            m_document->editWrapLine(line, column, true);
+            lastCursor = KTextEditor::Cursor(line + 1, 0);
             break;
         }
         case EA_UnwrapLine: {
-            if (!editRunning) {
-                brokenSwapFile = true;
-                break;
-            }
-
             int line = 0;
             stream >> line;
-
-            // assert valid line
-            Q_ASSERT(line > 0);
-
-            const int undoColumn = m_document->lineLength(line - 1);
-
-            // emulate buffer unwrapLine with document
-            m_document->editUnWrapLine(line - 1, true, 0);
-
-            // track undo/redo cursor
-            if (firstEditInGroup) {
-                firstEditInGroup = false;
-                undoCursor = KTextEditor::Cursor(line, 0);
+            if (stream.status() != QDataStream::Ok || line <= 0) {
+                return false;
             }
-            redoCursor = KTextEditor::Cursor(line - 1, undoColumn);
 
+            const int column = m_document->lineLength(line - 1);
+            m_document->editUnWrapLine(line - 1, true, 0);
+            lastCursor = KTextEditor::Cursor(line - 1, column);
             break;
         }
         case EA_InsertText: {
-            if (!editRunning) {
-                brokenSwapFile = true;
-                break;
-            }
-
-            int line;
-            int column;
+            int line = 0;
+            int column = 0;
             QByteArray text;
             stream >> line >> column >> text;
-            m_document->insertText(KTextEditor::Cursor(line, column), QString::fromUtf8(text.data(), text.size()));
-
-            // track undo/redo cursor
-            if (firstEditInGroup) {
-                firstEditInGroup = false;
-                undoCursor = KTextEditor::Cursor(line, column);
+            if (stream.status() != QDataStream::Ok) {
+                return false;
             }
-            redoCursor = KTextEditor::Cursor(line, column + text.size());
 
+            const QString insertedText = QString::fromUtf8(text);
+            m_document->editInsertText(line, column, insertedText);
+            lastCursor = KTextEditor::Cursor(line, column + insertedText.size());
             break;
         }
         case EA_RemoveText: {
-            if (!editRunning) {
-                brokenSwapFile = true;
-                break;
-            }
-
-            int line;
-            int startColumn;
-            int endColumn;
+            int line = 0;
+            int startColumn = 0;
+            int endColumn = 0;
             stream >> line >> startColumn >> endColumn;
-            m_document->removeText(KTextEditor::Range(KTextEditor::Cursor(line, startColumn), KTextEditor::Cursor(line, endColumn)));
-
-            // track undo/redo cursor
-            if (firstEditInGroup) {
-                firstEditInGroup = false;
-                undoCursor = KTextEditor::Cursor(line, endColumn);
+            if (stream.status() != QDataStream::Ok) {
+                return false;
             }
-            redoCursor = KTextEditor::Cursor(line, startColumn);
 
+            m_document->editRemoveText(line, startColumn, endColumn - startColumn);
+            lastCursor = KTextEditor::Cursor(line, startColumn);
             break;
         }
         default: {
             qCWarning(LOG_KTE) << "Unknown type:" << type;
+            return false;
         }
         }
     }
 
-    // balanced editStart and editEnd?
-    if (editRunning) {
-        brokenSwapFile = true;
-        m_document->editEnd();
-    }
+    // balanced start and finish?
+    return !editRunning;
+}
 
-    // warn the user if the swap file is not complete
-    if (brokenSwapFile) {
-        qCWarning(LOG_KTE) << "Some data might be lost";
-    } else {
-        // set sane final cursor, if possible
-        KTextEditor::View *view = m_document->activeView();
-        redoCursor = m_document->undoManager()->lastRedoCursor();
-        if (view && redoCursor.isValid()) {
-            view->setCursorPosition(redoCursor);
+bool SwapFile::replayTransaction(const QByteArray &transaction, KTextEditor::Cursor &lastCursor)
+{
+    const char *pos = transaction.constData();
+    const char *const end = pos + transaction.size();
+
+    // use the edit primitives, the recorded operations are exactly what they did emit
+    while (pos < end) {
+        const qint8 type = qint8(*pos++);
+        switch (type) {
+        case EA_WrapLine: {
+            int line = 0;
+            int column = 0;
+            if (!readVarint(pos, end, line) || !readVarint(pos, end, column)) {
+                return false;
+            }
+
+            m_document->editWrapLine(line, column, true);
+            lastCursor = KTextEditor::Cursor(line + 1, 0);
+            break;
         }
-    }
+        case EA_UnwrapLine: {
+            int line = 0;
+            if (!readVarint(pos, end, line) || line <= 0) {
+                return false;
+            }
 
-    // reconnect the signals
-    setTrackingEnabled(true);
+            const int column = m_document->lineLength(line - 1);
+            m_document->editUnWrapLine(line - 1, true, 0);
+            lastCursor = KTextEditor::Cursor(line - 1, column);
+            break;
+        }
+        case EA_InsertText: {
+            int line = 0;
+            int column = 0;
+            int length = 0;
+            if (!readVarint(pos, end, line) || !readVarint(pos, end, column) || !readVarint(pos, end, length) || length > end - pos) {
+                return false;
+            }
+
+            const QString text = QString::fromUtf8(pos, length);
+            pos += length;
+            m_document->editInsertText(line, column, text);
+            lastCursor = KTextEditor::Cursor(line, column + text.size());
+            break;
+        }
+        case EA_RemoveText: {
+            int line = 0;
+            int column = 0;
+            int length = 0;
+            if (!readVarint(pos, end, line) || !readVarint(pos, end, column) || !readVarint(pos, end, length)) {
+                return false;
+            }
+
+            m_document->editRemoveText(line, column, length);
+            lastCursor = KTextEditor::Cursor(line, column);
+            break;
+        }
+        default: {
+            qCWarning(LOG_KTE) << "Unknown type:" << type;
+            return false;
+        }
+        }
+    }
 
     return true;
 }
@@ -422,105 +608,189 @@ void SwapFile::startEditing()
         return;
     }
 
-    // if swap file doesn't exists, open it in WriteOnly mode
+    // if swap file doesn't exists, the writer creates it with our header
     // if it does, append the data to the existing swap file,
     // in case you recover and start editing again
-    if (!m_swapfile.exists()) {
+    if (!m_journalFile) {
         // create path if not there
         if (KateDocumentConfig::global()->swapFileMode() == KateDocumentConfig::SwapFilePresetDirectory
             && !QDir(KateDocumentConfig::global()->swapDirectory()).exists()) {
             QDir().mkpath(KateDocumentConfig::global()->swapDirectory());
         }
 
-        m_swapfile.open(QIODevice::WriteOnly);
-        m_swapfile.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
-        m_stream.setDevice(&m_swapfile);
-
-        // write file header
-        m_stream << QByteArray(swapFileVersionString);
+        // file header + checksum
+        QByteArray header;
+        QDataStream stream(&header, QIODevice::WriteOnly);
+        stream.setVersion(m_stream.version());
+        stream << QByteArray(swapFileVersionString);
+        stream << m_document->checksum();
 
-        // write checksum
-        m_stream << m_document->checksum();
-    } else if (m_stream.device() == nullptr) {
-        m_swapfile.open(QIODevice::Append);
-        m_swapfile.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
-        m_stream.setDevice(&m_swapfile);
+        m_journalFile = std::make_shared<SwapFileWriter::Journal>(m_swapfile.fileName());
+        SwapFileWriter::self()->open(m_journalFile, header);
+        m_journalFileSize = header.size();
     }
 
-    // format: qint8
-    m_stream << EA_StartEditing;
+    // collect the operations of this transaction
+    m_transaction.clear();
 }
 
 void SwapFile::finishEditing()
 {
     // skip if not open
-    if (!m_swapfile.isOpen()) {
+    if (!m_journalFile) {
         return;
     }
 
+    // empty editStart() / editEnd() groups exist, nothing to record
+    if (m_transaction.isEmpty()) {
+        return;
+    }
+
+    // one record per transaction, compress large ones, e.g. replace all
+    if (m_transaction.size() > journalCompressionSize) {
+        const QByteArray compressed = qCompress(m_transaction);
+        if (compressed.size() < m_transaction.size()) {
+            appendRecord(EA_CompressedTransaction, compressed);
+        } else {
+            appendRecord(EA_Transaction, m_transaction);
+        }
+    } else {
+        appendRecord(EA_Transaction, m_transaction);
+    }
+    m_transaction.clear();
+
+    // group commit: write once enough is pending, else soon
+    if (m_journal.size() >= journalCommitSize) {
+        commitJournal();
+    } else if (!m_commitTimer.isActive()) {
+        m_commitTimer.start();
+    }
+
     // write the file to the disk every 15 seconds (default)
     // skip this if we disabled that
     if (m_document->config()->swapSyncInterval() != 0 && !syncTimer()->isActive()) {
         // important: we store the interval as seconds, start wants milliseconds!
         syncTimer()->start(m_document->config()->swapSyncInterval() * 1000);
     }
+}
 
-    // format: qint8
-    m_stream << EA_FinishEditing;
-    m_swapfile.flush();
+void SwapFile::appendRecord(qint8 type, const QByteArray &payload)
+{
+    // format: qint8, QDataStream compatible byte array (quint32 big endian length + data)
+    m_journal.append(char(type));
+    const quint32 length = qToBigEndian(quint32(payload.size()));
+    m_journal.append(reinterpret_cast<const char *>(&length), sizeof(length));
+    m_journal.append(payload);
 }
 
-void SwapFile::wrapLine(KTextEditor::Document *, const KTextEditor::Cursor position)
+void SwapFile::commitJournal()
 {
-    // skip if not open
-    if (!m_swapfile.isOpen()) {
+    m_commitTimer.stop();
+
+    if (m_journal.isEmpty() || !m_journalFile) {
+        m_journal.clear();
         return;
     }
 
-    // format: qint8, int, int
-    m_stream << EA_WrapLine << position.line() << position.column();
+    // the writer thread does the I/O, we never block on slow disks
+    SwapFileWriter::self()->write(m_journalFile, m_journal);
+    m_journalFileSize += m_journal.size();
+    m_journal.clear();
+    m_needSync = true;
 
+    // avoid ever growing swap files for long editing sessions
+    // only compact if this really shrinks the file, the checkpoint contains the full text
+    if (m_journalFileSize > journalCompactionSize && m_journalFileSize > 2 * m_document->totalCharacters()) {
+        compactJournal();
+    }
+}
+
+void SwapFile::compactJournal()
+{
+    // replace the journal with one checkpoint of the current text
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.setVersion(m_stream.version());
+    stream << QByteArray(swapFileVersionString);
+    stream << m_document->checksum();
+
+    // encoding and compressing the text is up to the writer thread, the snapshot keeps it for us
+    SwapFileWriter::self()->replace(m_journalFile,
+                                    [header, version = m_stream.version(), snapshot = m_document->buffer().snapshot()]() {
+                                        QByteArray content = header;
+                                        QDataStream stream(&content, QIODevice::WriteOnly | QIODevice::Append);
+                                        stream.setVersion(version);
+                                        stream << EA_Checkpoint << qCompress(snapshot.text().toUtf8());
+                                        return content;
+                                    });
+
+    // the compressed size is only known to the writer, the plain text is an upper bound for most text
+    m_journalFileSize = header.size() + m_document->totalCharacters();
     m_needSync = true;
 }
 
-void SwapFile::unwrapLine(KTextEditor::Document *, int line)
+void SwapFile::wrapLine(KTextEditor::Document *, const KTextEditor::Cursor position)
 {
     // skip if not open
-    if (!m_swapfile.isOpen()) {
+    if (!m_journalFile) {
         return;
     }
 
-    // format: qint8, int
-    m_stream << EA_UnwrapLine << line;
+    // format: qint8, varint, varint
+    m_transaction.append(char(EA_WrapLine));
+    appendVarint(m_transaction, position.line());
+    appendVarint(m_transaction, position.column());
+}
 
-    m_needSync = true;
+void SwapFile::unwrapLine(KTextEditor::Document *, int line)
+{
+    // skip if not open
+    if (!m_journalFile) {
+        return;
+    }
+
+    // format: qint8, varint
+    m_transaction.append(char(EA_UnwrapLine));
+    appendVarint(m_transaction, line);
 }
 
 void SwapFile::insertText(KTextEditor::Document *, const KTextEditor::Cursor position, const QString &text)
 {
     // skip if not open
-    if (!m_swapfile.isOpen()) {
+    if (!m_journalFile) {
         return;
     }
 
-    // format: qint8, int, int, bytearray
-    m_stream << EA_InsertText << position.line() << position.column() << text.toUtf8();
-
-    m_needSync = true;
+    // format: qint8, varint, varint, varint length, utf-8 bytes
+    m_transaction.append(char(EA_InsertText));
+    appendVarint(m_transaction, position.line());
+    appendVarint(m_transaction, position.column());
+
+    // encode directly behind room for the length, then move the bytes in place
+    const qsizetype offset = m_transaction.size();
+    m_transaction.resize(offset + maxVarintLength + m_encoder.requiredSpace(text.size()));
+    char *const textStart = m_transaction.data() + offset + maxVarintLength;
+    const qsizetype textLength = m_encoder.appendToBuffer(textStart, text) - textStart;
+    char length[maxVarintLength];
+    const int lengthLength = encodeVarint(length, quint32(textLength));
+    memmove(m_transaction.data() + offset + lengthLength, textStart, textLength);
+    memcpy(m_transaction.data() + offset, length, lengthLength);
+    m_transaction.resize(offset + lengthLength + textLength);
 }
 
 void SwapFile::removeText(KTextEditor::Document *, KTextEditor::Range range, const QString &)
 {
     // skip if not open
-    if (!m_swapfile.isOpen()) {
+    if (!m_journalFile) {
         return;
     }
 
-    // format: qint8, int, int, int
+    // format: qint8, varint, varint, varint length
     Q_ASSERT(range.start().line() == range.end().line());
-    m_stream << EA_RemoveText << range.start().line() << range.start().column() << range.end().column();
-
-    m_needSync = true;
+    m_transaction.append(char(EA_RemoveText));
+    appendVarint(m_transaction, range.start().line());
+    appendVarint(m_transaction, range.start().column());
+    appendVarint(m_transaction, range.end().column() - range.start().column());
 }
 
 bool SwapFile::shouldRecover() const
@@ -530,7 +800,7 @@ bool SwapFile::shouldRecover() const
         return false;
     }
 
-    return !m_swapfile.fileName().isEmpty() && m_swapfile.exists() && m_stream.device() == nullptr;
+    return !m_swapfile.fileName().isEmpty() && !m_journalFile && m_pendingRemovals == 0 && m_swapfile.exists();
 }
 
 void SwapFile::discard()
@@ -547,6 +817,22 @@ void SwapFile::discard()
 
 void SwapFile::removeSwapFile()
 {
+    // pending records are obsolete
+    m_commitTimer.stop();
+    m_journal.clear();
+    m_transaction.clear();
+
+    // the writer owns the file we are writing to, it will delete it after all pending writes
+    if (m_journalFile) {
+        SwapFileWriter::self()->remove(m_journalFile);
+        m_journalFile.reset();
+        ++m_pendingRemovals;
+        SwapFileWriter::self()->notify(this, [this]() {
+            --m_pendingRemovals;
+        });
+        return;
+    }
+
     if (!m_swapfile.fileName().isEmpty() && m_swapfile.exists()) {
         m_stream.setDevice(nullptr);
         m_swapfile.close();
@@ -610,17 +896,14 @@ QTimer *SwapFile::syncTimer()
 
 void SwapFile::writeFileToDisk()
 {
-    if (m_needSync) {
+    // sync pending records, too
+    commitJournal();
+
+    if (m_needSync && m_journalFile) {
         m_needSync = false;
 
-#ifndef Q_OS_WIN
-        // ensure that the file is written to disk
-#if HAVE_FDATASYNC
-        fdatasync(m_swapfile.handle());
-#else
-        fsync(m_swapfile.handle());
-#endif
-#endif
+        // ensure that the file is written to disk, in the writer thread
+        SwapFileWriter::self()->sync(m_journalFile);
     }
 }
 
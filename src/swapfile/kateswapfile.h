@@ -8,12 +8,22 @@
 #ifndef KATE_SWAPFILE_H
 #define KATE_SWAPFILE_H
 
+#include <QByteArray>
 #include <QDataStream>
 #include <QFile>
 #include <QObject>
 #include <QPointer>
+#include <QStringEncoder>
+#include <QTimer>
+
+#include <ktexteditor_export.h>
+
+#include <memory>
+
+#include "kateswapfilewriter.h"
+
+class SwapFileTest;
 
-class QTimer;
 namespace KTextEditor
 {
 class ViewPrivate;
@@ -33,13 +43,15 @@ namespace Kate
  */
 class SwapFile : public QObject
 {
+    friend class ::SwapFileTest;
+
 public:
     explicit SwapFile(KTextEditor::DocumentPrivate *document);
     ~SwapFile() override;
     bool shouldRecover() const;
 
     void fileClosed();
-    QString fileName();
+    KTEXTEDITOR_EXPORT QString fileName();
 
     KTextEditor::DocumentPrivate *document();
 
@@ -47,7 +59,13 @@ private:
     void setTrackingEnabled(bool trackingEnabled);
     void removeSwapFile();
     bool updateFileName();
-    bool isValidSwapFile(QDataStream &stream, bool checkDigest) const;
+    void checkSwapFile();
+    bool isValidSwapFile(QDataStream &stream, bool checkDigest, int &version) const;
+    bool replayVersion2(QDataStream &stream, KTextEditor::Cursor &lastCursor);
+    bool replayTransaction(const QByteArray &transaction, KTextEditor::Cursor &lastCursor);
+    void appendRecord(qint8 type, const QByteArray &payload);
+    KTEXTEDITOR_EXPORT void commitJournal();
+    void compactJournal();
 
 private:
     KTextEditor::DocumentPrivate *m_document;
@@ -69,7 +87,7 @@ protected:
 public:
     void discard();
     void recover();
-    bool recover(QDataStream &, bool checkDigest = true);
+    KTEXTEDITOR_EXPORT bool recover(QDataStream &, bool checkDigest = true);
     void configChanged();
 
 private:
@@ -79,8 +97,42 @@ private:
     bool m_needSync;
     static QTimer *s_timer;
 
+    /**
+     * Operations of the running editing transaction, varint encoded.
+     * Written as one record to the journal in finishEditing().
+     */
+    QByteArray m_transaction;
+
+    /**
+     * Records of finished transactions not yet written to the swap file.
+     * Committed in groups, either if enough data is pending or after m_commitTimer fired.
+     */
+    QByteArray m_journal;
+    QTimer m_commitTimer;
+
+    /**
+     * Swap file we are writing to, owned by the SwapFileWriter thread.
+     * Not set if we are not tracking the edits.
+     */
+    std::shared_ptr<SwapFileWriter::Journal> m_journalFile;
+
+    /**
+     * Journals handed to the writer for removal, their files might still exist for a moment
+     */
+    int m_pendingRemovals = 0;
+
+    /**
+     * Size of the swap file on disk, used to decide when to compact it
+     */
+    qint64 m_journalFileSize = 0;
+
+    /**
+     * Encoder for inserted text, avoids temporary byte arrays
+     */
+    QStringEncoder m_encoder;
+
 protected:
-    void writeFileToDisk();
+    KTEXTEDITOR_EXPORT void writeFileToDisk();
 
 private:
     static QTimer *syncTimer();
@@ -0,0 +1,215 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "config.h"
+
+#include "kateswapfilewriter.h"
+#include "kateglobal.h"
+#include "katepartdebug.h"
+
+#include <QPointer>
+#include <QSaveFile>
+
+#ifndef Q_OS_WIN
+#include <unistd.h>
+#endif
+
+namespace Kate
+{
+SwapFileWriter *SwapFileWriter::self()
+{
+    return KTextEditor::EditorPrivate::self()->swapFileWriter();
+}
+
+SwapFileWriter::SwapFileWriter()
+    : m_head(new Node)
+    , m_tail(m_head)
+{
+    setObjectName(QStringLiteral("SwapFileWriter"));
+    start(QThread::LowPriority);
+}
+
+SwapFileWriter::~SwapFileWriter()
+{
+    enqueue(Command{.type = Command::Quit});
+    wait();
+
+    // only the stub node is left
+    delete m_head;
+}
+
+void SwapFileWriter::open(const std::shared_ptr<Journal> &journal, const QByteArray &header)
+{
+    enqueue(Command{.type = Command::Open, .journal = journal, .data = header});
+}
+
+void SwapFileWriter::write(const std::shared_ptr<Journal> &journal, const QByteArray &data)
+{
+    enqueue(Command{.type = Command::Write, .journal = journal, .data = data});
+}
+
+void SwapFileWriter::sync(const std::shared_ptr<Journal> &journal)
+{
+    enqueue(Command{.type = Command::Sync, .journal = journal});
+}
+
+void SwapFileWriter::replace(const std::shared_ptr<Journal> &journal, std::function<QByteArray()> content)
+{
+    enqueue(Command{.type = Command::Replace, .journal = journal, .content = std::move(content)});
+}
+
+void SwapFileWriter::remove(const std::shared_ptr<Journal> &journal)
+{
+    enqueue(Command{.type = Command::Remove, .journal = journal});
+}
+
+void SwapFileWriter::call(std::function<void()> function)
+{
+    enqueue(Command{.type = Command::Call, .function = std::move(function)});
+}
+
+void SwapFileWriter::notify(QObject *context, std::function<void()> function)
+{
+    // we live in the GUI thread, post to ourself and check there if the context is still alive
+    call([this, context = QPointer<QObject>(context), function = std::move(function)]() {
+        QMetaObject::invokeMethod(
+            this,
+            [context, function]() {
+                if (context) {
+                    function();
+                }
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void SwapFileWriter::waitForIdle()
+{
+    QSemaphore done;
+    enqueue(Command{.type = Command::Idle, .done = &done});
+    done.acquire();
+}
+
+void SwapFileWriter::enqueue(Command command)
+{
+    // producer side: publish the new node, the writer might already wait for it
+    Node *node = new Node;
+    node->command = std::move(command);
+    m_tail->next.store(node, std::memory_order_release);
+    m_tail = node;
+    m_queued.release();
+}
+
+bool SwapFileWriter::dequeue(Command &command)
+{
+    // consumer side: the next node becomes the new stub
+    Node *next = m_head->next.load(std::memory_order_acquire);
+    if (!next) {
+        return false;
+    }
+    command = std::move(next->command);
+    delete m_head;
+    m_head = next;
+    return true;
+}
+
+void SwapFileWriter::run()
+{
+    while (true) {
+        m_queued.acquire();
+
+        Command command;
+        if (!dequeue(command)) {
+            continue;
+        }
+
+        if (command.type == Command::Quit) {
+            return;
+        }
+
+        execute(command);
+    }
+}
+
+void SwapFileWriter::execute(Command &command)
+{
+    QFile *file = command.journal ? &command.journal->file : nullptr;
+
+    switch (command.type) {
+    case Command::Open: {
+        if (file->isOpen()) {
+            break;
+        }
+        // append the data to an existing swap file, in case you recover and start editing again
+        const bool exists = file->exists();
+        if (!file->open(exists ? QIODevice::Append : QIODevice::WriteOnly)) {
+            qCWarning(LOG_KTE) << "Can't open swap file:" << file->fileName();
+            break;
+        }
+        file->setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+        if (!exists) {
+            file->write(command.data);
+            file->flush();
+        }
+        break;
+    }
+    case Command::Write: {
+        if (!file->isOpen()) {
+            break;
+        }
+        file->write(command.data);
+        file->flush();
+        break;
+    }
+    case Command::Sync: {
+        if (!file->isOpen()) {
+            break;
+        }
+#ifndef Q_OS_WIN
+        // ensure that the file is written to disk
+#if HAVE_FDATASYNC
+        fdatasync(file->handle());
+#else
+        fsync(file->handle());
+#endif
+#endif
+        break;
+    }
+    case Command::Replace: {
+        QSaveFile newFile(file->fileName());
+        if (!newFile.open(QIODevice::WriteOnly)) {
+            break;
+        }
+        newFile.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+        newFile.write(command.content());
+        if (!newFile.commit()) {
+            qCWarning(LOG_KTE) << "Can't compact swap file:" << file->fileName();
+            break;
+        }
+
+        // continue appending to the compacted file
+        file->close();
+        file->open(QIODevice::Append);
+        break;
+    }
+    case Command::Remove: {
+        file->close();
+        file->remove();
+        break;
+    }
+    case Command::Call: {
+        command.function();
+        break;
+    }
+    case Command::Idle: {
+        command.done->release();
+        break;
+    }
+    case Command::Quit:
+        break;
+    }
+}
+}
@@ -0,0 +1,152 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE Developers
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KATE_SWAPFILEWRITER_H
+#define KATE_SWAPFILEWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QSemaphore>
+#include <QThread>
+
+#include <ktexteditor_export.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace Kate
+{
+/**
+ * Thread doing all writing and syncing of swap files.
+ *
+ * The GUI thread is the only producer, it enqueues commands for a journal
+ * into a lock-free single producer single consumer queue. The writer thread
+ * executes them in order. Once a journal is handed over to the writer, only
+ * the writer thread touches the file, slow disks never block editing.
+ */
+class KTEXTEDITOR_EXPORT SwapFileWriter : public QThread
+{
+public:
+    /**
+     * One swap file on disk, owned by the writer thread once created.
+     */
+    struct Journal {
+        explicit Journal(const QString &fileName)
+            : file(fileName)
+        {
+        }
+
+        QFile file;
+    };
+
+    /**
+     * The writer shared by all swap files, owned by the EditorPrivate.
+     */
+    static SwapFileWriter *self();
+
+    /**
+     * Starts the writer thread, use self() instead of creating your own.
+     */
+    SwapFileWriter();
+
+    /**
+     * Executes all pending commands and stops the thread.
+     */
+    ~SwapFileWriter() override;
+
+    /**
+     * Open the journal for appending, if the file doesn't exist it is created with the given header.
+     */
+    void open(const std::shared_ptr<Journal> &journal, const QByteArray &header);
+
+    /**
+     * Append data to the journal.
+     */
+    void write(const std::shared_ptr<Journal> &journal, const QByteArray &data);
+
+    /**
+     * Ensure the journal is written to the disk.
+     */
+    void sync(const std::shared_ptr<Journal> &journal);
+
+    /**
+     * Atomically replace the journal with new content and continue appending to it.
+     * The content is computed in the writer thread, after all commands queued before.
+     */
+    void replace(const std::shared_ptr<Journal> &journal, std::function<QByteArray()> content);
+
+    /**
+     * Close and delete the journal.
+     */
+    void remove(const std::shared_ptr<Journal> &journal);
+
+    /**
+     * Call the function in the writer thread once all commands queued before are executed.
+     */
+    void call(std::function<void()> function);
+
+    /**
+     * Call the function in the GUI thread once all commands queued before are executed.
+     * Nothing is called if the context object is gone by then.
+     */
+    void notify(QObject *context, std::function<void()> function);
+
+    /**
+     * Block until all queued commands are executed.
+     * Only for unit tests and shutdown, never call this during editing.
+     */
+    void waitForIdle();
+
+protected:
+    void run() override;
+
+private:
+    struct Command {
+        enum Type {
+            Open,
+            Write,
+            Sync,
+            Replace,
+            Remove,
+            Call,
+            Idle,
+            Quit
+        };
+
+        Type type = Quit;
+        std::shared_ptr<Journal> journal;
+        QByteArray data;
+        std::function<void()> function;
+        std::function<QByteArray()> content;
+        QSemaphore *done = nullptr;
+    };
+
+    struct Node {
+        std::atomic<Node *> next = nullptr;
+        Command command;
+    };
+
+    void enqueue(Command command);
+    bool dequeue(Command &command);
+    void execute(Command &command);
+
+private:
+    /**
+     * Unbounded SPSC queue, m_head is only touched by the writer thread, m_tail only by the GUI thread.
+     * Starts with a stub node, m_head always points to the last consumed node.
+     */
+    Node *m_head;
+    Node *m_tail;
+
+    /**
+     * Number of queued commands, the writer sleeps on this
+     */
+    QSemaphore m_queued;
+};
+}
+
+#endif // KATE_SWAPFILEWRITER_H
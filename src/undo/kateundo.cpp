@@ -30,6 +30,60 @@ KateUndoGroup::KateUndoGroup(const KTextEditor::Cursor cursorPosition,
 {
 }
 
+/**
+ * Groups with at least that many items are undone/redone line by line, e.g. after a large replace.
+ */
+static constexpr size_t BulkApplyItemCount = 1000;
+
+/**
+ * End of the run of text insertions/removals on the same line starting at it.
+ */
+template<typename It>
+static It textRunEnd(It it, const It end)
+{
+    const int line = it->line;
+    while (it != end && (it->type == UndoItem::editInsertText || it->type == UndoItem::editRemoveText) && it->line == line) {
+        ++it;
+    }
+    return it;
+}
+
+template<typename It>
+void KateUndoGroup::applyTextRun(KTextEditor::DocumentPrivate *doc, It begin, const It end, bool undo) const
+{
+    // compute the final line text, no buffer changes, no signals
+    const int line = begin->line;
+    const QString oldText = doc->line(line);
+    QString newText = oldText;
+    for (auto it = begin; it != end; ++it) {
+        if ((it->type == UndoItem::editInsertText) != undo) {
+            newText.insert(it->col, QStringView(m_text).mid(it->textOffset, it->textLength));
+        } else {
+            newText.remove(it->col, it->textLength);
+        }
+    }
+
+    // replace only the changed middle of the line, cursors outside of it stay where they are
+    const qsizetype maxCommon = std::min(oldText.size(), newText.size());
+    qsizetype prefix = 0;
+    while (prefix < maxCommon && oldText[prefix] == newText[prefix]) {
+        ++prefix;
+    }
+    qsizetype suffix = 0;
+    while (suffix < maxCommon - prefix && oldText[oldText.size() - 1 - suffix] == newText[newText.size() - 1 - suffix]) {
+        ++suffix;
+    }
+
+    const int removeLength = oldText.size() - prefix - suffix;
+    if (removeLength > 0) {
+        doc->editRemoveText(line, prefix, removeLength);
+    }
+    const int insertLength = newText.size() - prefix - suffix;
+    if (insertLength > 0) {
+        doc->editInsertText(line, prefix, newText.mid(prefix, insertLength));
+    }
+}
+
 void KateUndoGroup::undo(KateUndoManager *manager, KTextEditor::ViewPrivate *view)
 {
     if (m_items.empty()) {
@@ -46,15 +100,27 @@ void KateUndoGroup::undo(KateUndoManager *manager, KTextEditor::ViewPrivate *vie
         doc->buffer().setLineMetaData(item.line, tl);
     };
 
+    const bool bulk = m_items.size() >= BulkApplyItemCount;
     for (auto rit = m_items.rbegin(); rit != m_items.rend(); ++rit) {
+        // large groups: apply all text changes of one line at once
+        if (bulk) {
+            const auto runEnd = textRunEnd(rit, m_items.rend());
+            if (runEnd - rit > 1) {
+                applyTextRun(doc, rit, runEnd, true);
+                rit = runEnd - 1;
+                updateDocLine(*rit);
+                continue;
+            }
+        }
+
         auto &item = *rit;
         switch (item.type) {
         case UndoItem::editInsertText:
-            doc->editRemoveText(item.line, item.col, item.text.size());
+            doc->editRemoveText(item.line, item.col, item.textLength);
             updateDocLine(item);
             break;
         case UndoItem::editRemoveText:
-            doc->editInsertText(item.line, item.col, item.text);
+            doc->editInsertText(item.line, item.col, itemText(item));
             updateDocLine(item);
             break;
         case UndoItem::editWrapLine:
@@ -74,7 +140,7 @@ void KateUndoGroup::undo(KateUndoManager *manager, KTextEditor::ViewPrivate *vie
             doc->editRemoveLine(item.line);
             break;
         case UndoItem::editRemoveLine:
-            doc->editInsertLine(item.line, item.text);
+            doc->editInsertLine(item.line, itemText(item));
             updateDocLine(item);
             break;
         case UndoItem::editMarkLineAutoWrapped:
@@ -118,14 +184,27 @@ void KateUndoGroup::redo(KateUndoManager *manager, KTextEditor::ViewPrivate *vie
         doc->buffer().setLineMetaData(item.line, tl);
     };
 
-    for (auto &item : m_items) {
+    const bool bulk = m_items.size() >= BulkApplyItemCount;
+    for (auto it = m_items.begin(); it != m_items.end(); ++it) {
+        // large groups: apply all text changes of one line at once
+        if (bulk) {
+            const auto runEnd = textRunEnd(it, m_items.end());
+            if (runEnd - it > 1) {
+                applyTextRun(doc, it, runEnd, false);
+                it = runEnd - 1;
+                updateDocLine(*it);
+                continue;
+            }
+        }
+
+        auto &item = *it;
         switch (item.type) {
         case UndoItem::editInsertText:
-            doc->editInsertText(item.line, item.col, item.text);
+            doc->editInsertText(item.line, item.col, itemText(item));
             updateDocLine(item);
             break;
         case UndoItem::editRemoveText:
-            doc->editRemoveText(item.line, item.col, item.text.size());
+            doc->editRemoveText(item.line, item.col, item.textLength);
             updateDocLine(item);
             break;
         case UndoItem::editWrapLine: {
@@ -142,7 +221,7 @@ void KateUndoGroup::redo(KateUndoManager *manager, KTextEditor::ViewPrivate *vie
             updateDocLine(item);
             break;
         case UndoItem::editInsertLine:
-            doc->editInsertLine(item.line, item.text);
+            doc->editInsertLine(item.line, itemText(item));
             updateDocLine(item);
             break;
         case UndoItem::editRemoveLine:
@@ -182,11 +261,16 @@ void KateUndoGroup::editEnd(const KTextEditor::Cursor cursorPosition,
     m_redoSelection = selectionRange;
 }
 
-static bool mergeUndoItems(UndoItem &base, const UndoItem &u)
+/**
+ * Try to merge u into base, base is the last item of the group, its text is at the end of the arena.
+ */
+static bool mergeUndoItems(UndoItem &base, const UndoItem &u, QStringView text, QString &arena)
 {
+    Q_ASSERT(base.textOffset + base.textLength == arena.size());
+
     if (base.type == UndoItem::editInsertText && u.type == UndoItem::editWrapLine) {
         // merge insert text full line + wrap line
-        if (base.col == 0 && base.line == u.line && base.col + base.text.length() == u.col && u.newLine) {
+        if (base.col == 0 && base.line == u.line && base.col + base.textLength == u.col && u.newLine) {
             base.type = UndoItem::editInsertLine;
             base.lineModFlags.setFlag(UndoItem::RedoLine1Modified);
             return true;
@@ -194,16 +278,19 @@ static bool mergeUndoItems(UndoItem &base, const UndoItem &u)
     }
 
     if (base.type == UndoItem::editRemoveText && base.type == u.type) {
-        if (base.line == u.line && base.col == (u.col + u.text.size())) {
-            base.text.prepend(u.text);
+        if (base.line == u.line && base.col == (u.col + text.size())) {
+            // backspace: the base text is the tail of the arena, only that is moved
+            arena.insert(base.textOffset, text);
+            base.textLength += text.size();
             base.col = u.col;
             return true;
         }
     }
 
     if (base.type == UndoItem::editInsertText && base.type == u.type) {
-        if (base.line == u.line && (base.col + base.text.size()) == u.col) {
-            base.text += u.text;
+        if (base.line == u.line && (base.col + base.textLength) == u.col) {
+            arena.append(text);
+            base.textLength += text.size();
             return true;
         }
     }
@@ -211,14 +298,17 @@ static bool mergeUndoItems(UndoItem &base, const UndoItem &u)
     return false;
 }
 
-void KateUndoGroup::addItem(UndoItem u)
+void KateUndoGroup::addItem(UndoItem u, QStringView text)
 {
     // try to merge, do that only for equal types, inside mergeWith we do hard casts
-    if (!m_items.empty() && mergeUndoItems(m_items.back(), u)) {
+    if (!m_items.empty() && mergeUndoItems(m_items.back(), u, text, m_text)) {
         return;
     }
 
-    // default: just add new item unchanged
+    // default: just add new item, text appended to our arena
+    u.textOffset = m_text.size();
+    u.textLength = text.size();
+    m_text.append(text);
     m_items.push_back(std::move(u));
 }
 
@@ -231,9 +321,10 @@ bool KateUndoGroup::merge(KateUndoGroup *newGroup, bool complex)
     if (newGroup->isOnlyType(singleType()) || complex) {
         // Take all of its items first -> last
         for (auto &item : newGroup->m_items) {
-            addItem(item);
+            addItem(item, QStringView(newGroup->m_text).mid(item.textOffset, item.textLength));
         }
         newGroup->m_items.clear();
+        newGroup->m_text.clear();
 
         if (newGroup->m_safePoint) {
             safePoint();
@@ -255,28 +346,41 @@ void KateUndoGroup::safePoint(bool safePoint)
     m_safePoint = safePoint;
 }
 
-void KateUndoGroup::flagSavedAsModified()
+static void flagItemSavedAsModified(UndoItem &item)
 {
-    for (UndoItem &item : m_items) {
-        if (item.lineModFlags.testFlag(UndoItem::UndoLine1Saved)) {
-            item.lineModFlags.setFlag(UndoItem::UndoLine1Saved, false);
-            item.lineModFlags.setFlag(UndoItem::UndoLine1Modified, true);
-        }
+    if (item.lineModFlags.testFlag(UndoItem::UndoLine1Saved)) {
+        item.lineModFlags.setFlag(UndoItem::UndoLine1Saved, false);
+        item.lineModFlags.setFlag(UndoItem::UndoLine1Modified, true);
+    }
 
-        if (item.lineModFlags.testFlag(UndoItem::UndoLine2Saved)) {
-            item.lineModFlags.setFlag(UndoItem::UndoLine2Saved, false);
-            item.lineModFlags.setFlag(UndoItem::UndoLine2Modified, true);
-        }
+    if (item.lineModFlags.testFlag(UndoItem::UndoLine2Saved)) {
+        item.lineModFlags.setFlag(UndoItem::UndoLine2Saved, false);
+        item.lineModFlags.setFlag(UndoItem::UndoLine2Modified, true);
+    }
 
-        if (item.lineModFlags.testFlag(UndoItem::RedoLine1Saved)) {
-            item.lineModFlags.setFlag(UndoItem::RedoLine1Saved, false);
-            item.lineModFlags.setFlag(UndoItem::RedoLine1Modified, true);
-        }
+    if (item.lineModFlags.testFlag(UndoItem::RedoLine1Saved)) {
+        item.lineModFlags.setFlag(UndoItem::RedoLine1Saved, false);
+        item.lineModFlags.setFlag(UndoItem::RedoLine1Modified, true);
+    }
 
-        if (item.lineModFlags.testFlag(UndoItem::RedoLine2Saved)) {
-            item.lineModFlags.setFlag(UndoItem::RedoLine2Saved, false);
-            item.lineModFlags.setFlag(UndoItem::RedoLine2Modified, true);
-        }
+    if (item.lineModFlags.testFlag(UndoItem::RedoLine2Saved)) {
+        item.lineModFlags.setFlag(UndoItem::RedoLine2Saved, false);
+        item.lineModFlags.setFlag(UndoItem::RedoLine2Modified, true);
+    }
+}
+
+void KateUndoGroup::flagSavedAsModified()
+{
+    for (UndoItem &item : m_items) {
+        flagItemSavedAsModified(item);
+    }
+}
+
+void KateUndoGroup::touchedLines(QSet<int> &lines) const
+{
+    for (const UndoItem &item : m_items) {
+        lines.insert(item.line);
+        lines.insert(item.line + 1);
     }
 }
 
@@ -339,6 +443,16 @@ void KateUndoGroup::markUndoAsSaved(QBitArray &lines)
     }
 }
 
+void KateUndoGroup::markItemUndoAsSaved(int item, QBitArray &lines, bool apply)
+{
+    UndoItem copy = m_items[item];
+    flagItemSavedAsModified(copy);
+    updateUndoSavedOnDiskFlag(copy, lines);
+    if (apply) {
+        m_items[item].lineModFlags = copy.lineModFlags;
+    }
+}
+
 static void updateRedoSavedOnDiskFlag(UndoItem &item, QBitArray &lines)
 {
     const int line = item.line;
@@ -394,6 +508,16 @@ void KateUndoGroup::markRedoAsSaved(QBitArray &lines)
     }
 }
 
+void KateUndoGroup::markItemRedoAsSaved(int item, QBitArray &lines, bool apply)
+{
+    UndoItem copy = m_items[item];
+    flagItemSavedAsModified(copy);
+    updateRedoSavedOnDiskFlag(copy, lines);
+    if (apply) {
+        m_items[item].lineModFlags = copy.lineModFlags;
+    }
+}
+
 UndoItem::UndoType KateUndoGroup::singleType() const
 {
     UndoItem::UndoType ret = UndoItem::editInvalid;
@@ -15,6 +15,7 @@
 #include <QList>
 
 #include <QBitArray>
+#include <QSet>
 #include <kateview.h>
 #include <ktexteditor/range.h>
 
@@ -54,7 +55,14 @@ public:
     ModificationFlags lineModFlags;
     int line = 0;
     int col = 0;
-    QString text;
+
+    /**
+     * The text of the item is stored in the text arena of its KateUndoGroup,
+     * this is the range of it in there.
+     */
+    int textOffset = 0;
+    int textLength = 0;
+
     bool autowrapped = false;
     bool newLine = false;
     bool removeLine = false;
@@ -117,6 +125,15 @@ public:
         return m_items.empty();
     }
 
+    /**
+     * Approximate heap + object memory used by this group.
+     */
+    qsizetype memoryUsage() const
+    {
+        return sizeof(KateUndoGroup) + qsizetype(m_items.capacity() * sizeof(UndoItem)) + m_text.capacity() * qsizetype(sizeof(QChar))
+            + (m_undoSecondaryCursors.capacity() + m_redoSecondaryCursors.capacity()) * qsizetype(sizeof(KTextEditor::ViewPrivate::PlainSecondaryCursor));
+    }
+
     /**
      * Change all LineSaved flags to LineModified of the line modification system.
      */
@@ -125,6 +142,28 @@ public:
     void markUndoAsSaved(QBitArray &lines);
     void markRedoAsSaved(QBitArray &lines);
 
+    /**
+     * markUndoAsSaved()/markRedoAsSaved() for a single item, after turning its saved flags into modified.
+     * @param apply if false, only @p lines is updated and the item stays as it is
+     */
+    void markItemUndoAsSaved(int item, QBitArray &lines, bool apply);
+    void markItemRedoAsSaved(int item, QBitArray &lines, bool apply);
+
+    /**
+     * Add the lines changed by the items to @p lines, including the line after each of them.
+     */
+    void touchedLines(QSet<int> &lines) const;
+
+    int itemCount() const
+    {
+        return int(m_items.size());
+    }
+
+    int itemLine(int item) const
+    {
+        return m_items[item].line;
+    }
+
     /**
      * Set the undo cursor to @p cursor.
      */
@@ -164,15 +203,38 @@ public:
     /**
      * add an undo item
      * @param u item to add
+     * @param text text of the item, will be stored in the text arena of this group
      */
-    void addItem(UndoItem u);
+    void addItem(UndoItem u, QStringView text = {});
 
 private:
+    /**
+     * Apply the text insertions/removals of one line between begin and end
+     * as one removal and one insertion of the changed part of the line.
+     * @param undo undo the items, else redo them
+     */
+    template<typename It>
+    void applyTextRun(KTextEditor::DocumentPrivate *doc, It begin, const It end, bool undo) const;
+
+    /**
+     * text of the given item
+     */
+    QString itemText(const UndoItem &item) const
+    {
+        return m_text.mid(item.textOffset, item.textLength);
+    }
+
     /**
      * list of items contained
      */
     std::vector<UndoItem> m_items;
 
+    /**
+     * Append-only arena with the text of all items, in item order.
+     * Avoids one heap allocated string per item, adjacent items are merged inside it.
+     */
+    QString m_text;
+
     /**
      * prohibit merging with the next group
      */
@@ -14,6 +14,20 @@
 
 #include <QBitArray>
 
+#include <algorithm>
+
+/**
+ * Memory used by the given undo groups
+ */
+static qsizetype memoryUsageOf(const std::deque<KateUndoGroup> &groups)
+{
+    qsizetype usage = 0;
+    for (const KateUndoGroup &group : groups) {
+        usage += group.memoryUsage();
+    }
+    return usage;
+}
+
 KateUndoManager::KateUndoManager(KTextEditor::DocumentPrivate *doc)
     : QObject(doc)
     , m_document(doc)
@@ -27,6 +41,11 @@ KateUndoManager::KateUndoManager(KTextEditor::DocumentPrivate *doc)
     connect(doc, &KTextEditor::DocumentPrivate::aboutToReload, this, [this] {
         savedUndoItems = std::move(undoItems);
         savedRedoItems = std::move(redoItems);
+        undoItems.clear();
+        redoItems.clear();
+        m_memoryUsage = 0;
+        m_undoLineIndex = {};
+        m_redoLineIndex = {};
         docChecksumBeforeReload = m_document->checksum();
     });
 
@@ -35,6 +54,9 @@ KateUndoManager::KateUndoManager(KTextEditor::DocumentPrivate *doc)
         if (doc && !doc->checksum().isEmpty() && !docChecksumBeforeReload.isEmpty() && doc->checksum() == docChecksumBeforeReload) {
             undoItems = std::move(savedUndoItems);
             redoItems = std::move(savedRedoItems);
+            m_memoryUsage = memoryUsageOf(undoItems) + memoryUsageOf(redoItems);
+            m_undoLineIndex = {};
+            m_redoLineIndex = {};
             Q_EMIT undoChanged();
         }
         docChecksumBeforeReload.clear();
@@ -93,17 +115,24 @@ void KateUndoManager::editEnd()
 
     bool changedUndo = false;
 
+    const qsizetype lastGroupUsage = undoItems.empty() ? 0 : undoItems.back().memoryUsage();
     if (m_editCurrentUndo->isEmpty()) {
         m_editCurrentUndo.reset();
     } else if (!undoItems.empty() && undoItems.back().merge(&*m_editCurrentUndo, m_undoComplexMerge)) {
+        m_memoryUsage += undoItems.back().memoryUsage() - lastGroupUsage;
+        groupChanged(undoItems, m_undoLineIndex, undoItems.size() - 1);
         m_editCurrentUndo.reset();
     } else {
+        m_memoryUsage += m_editCurrentUndo->memoryUsage();
         undoItems.push_back(std::move(*m_editCurrentUndo));
         changedUndo = true;
     }
 
     m_editCurrentUndo.reset();
 
+    // stay within our memory budget
+    trimUndoHistory();
+
     if (changedUndo) {
         Q_EMIT undoChanged();
     }
@@ -145,7 +174,6 @@ void KateUndoManager::slotTextInserted(int line, int col, const QString &s, cons
     item.type = UndoItem::editInsertText;
     item.line = line;
     item.col = col;
-    item.text = s;
     item.lineModFlags.setFlag(UndoItem::RedoLine1Modified);
 
     if (tl.markedAsModified()) {
@@ -153,7 +181,7 @@ void KateUndoManager::slotTextInserted(int line, int col, const QString &s, cons
     } else {
         item.lineModFlags.setFlag(UndoItem::UndoLine1Saved);
     }
-    addUndoItem(std::move(item));
+    addUndoItem(std::move(item), s);
 }
 
 void KateUndoManager::slotTextRemoved(int line, int col, const QString &s, const Kate::TextLine &tl)
@@ -166,7 +194,6 @@ void KateUndoManager::slotTextRemoved(int line, int col, const QString &s, const
     item.type = UndoItem::editRemoveText;
     item.line = line;
     item.col = col;
-    item.text = s;
     item.lineModFlags.setFlag(UndoItem::RedoLine1Modified);
 
     if (tl.markedAsModified()) {
@@ -174,7 +201,7 @@ void KateUndoManager::slotTextRemoved(int line, int col, const QString &s, const
     } else {
         item.lineModFlags.setFlag(UndoItem::UndoLine1Saved);
     }
-    addUndoItem(std::move(item));
+    addUndoItem(std::move(item), s);
 }
 
 void KateUndoManager::slotMarkLineAutoWrapped(int line, bool autowrapped)
@@ -299,9 +326,8 @@ void KateUndoManager::slotLineInserted(int line, const QString &s)
         UndoItem item;
         item.type = UndoItem::editInsertLine;
         item.line = line;
-        item.text = s;
         item.lineModFlags.setFlag(UndoItem::RedoLine1Modified);
-        addUndoItem(std::move(item));
+        addUndoItem(std::move(item), s);
     }
 }
 
@@ -311,7 +337,6 @@ void KateUndoManager::slotLineRemoved(int line, const QString &s, const Kate::Te
         UndoItem item;
         item.type = UndoItem::editRemoveLine;
         item.line = line;
-        item.text = s;
         item.lineModFlags.setFlag(UndoItem::RedoLine1Modified);
 
         if (tl.markedAsModified()) {
@@ -319,7 +344,7 @@ void KateUndoManager::slotLineRemoved(int line, const QString &s, const Kate::Te
         } else {
             item.lineModFlags.setFlag(UndoItem::UndoLine1Saved);
         }
-        addUndoItem(std::move(item));
+        addUndoItem(std::move(item), s);
     }
 }
 
@@ -342,14 +367,45 @@ void KateUndoManager::undoSafePoint()
     }
 }
 
-void KateUndoManager::addUndoItem(UndoItem undo)
+void KateUndoManager::addUndoItem(UndoItem undo, const QString &text)
 {
     Q_ASSERT(m_editCurrentUndo.has_value()); // make sure there is an undo group for our item
 
-    m_editCurrentUndo->addItem(std::move(undo));
+    m_editCurrentUndo->addItem(std::move(undo), text);
 
     // Clear redo buffer
-    redoItems.clear();
+    if (!redoItems.empty()) {
+        m_memoryUsage -= memoryUsageOf(redoItems);
+        redoItems.clear();
+        m_redoLineIndex = {};
+    }
+}
+
+void KateUndoManager::trimUndoHistory()
+{
+    const qsizetype limit = qsizetype(m_document->config()->undoMemoryLimit()) * 1024 * 1024;
+    if (limit <= 0 || m_memoryUsage <= limit || undoItems.size() <= 1) {
+        return;
+    }
+
+    // drop the oldest groups, always keep the latest one
+    while (m_memoryUsage > limit && undoItems.size() > 1) {
+        groupsDropped(undoItems, m_undoLineIndex, 1);
+        const KateUndoGroup *oldest = &undoItems.front();
+        if (oldest == lastUndoGroupWhenSaved) {
+            lastUndoGroupWhenSaved = nullptr;
+        }
+        if (oldest == lastRedoGroupWhenSaved) {
+            lastRedoGroupWhenSaved = nullptr;
+        }
+        m_memoryUsage -= oldest->memoryUsage();
+        undoItems.pop_front();
+    }
+
+    // we can't undo back to an empty history anymore
+    docWasSavedWhenUndoWasEmpty = false;
+
+    Q_EMIT undoChanged();
 }
 
 void KateUndoManager::setActive(bool enabled)
@@ -379,6 +435,7 @@ void KateUndoManager::undo()
     if (!undoItems.empty()) {
         Q_EMIT undoStart(document());
 
+        groupChanged(undoItems, m_undoLineIndex, undoItems.size() - 1);
         undoItems.back().undo(this, activeView());
         redoItems.push_back(std::move(undoItems.back()));
         undoItems.pop_back();
@@ -395,6 +452,7 @@ void KateUndoManager::redo()
     if (!redoItems.empty()) {
         Q_EMIT redoStart(document());
 
+        groupChanged(redoItems, m_redoLineIndex, redoItems.size() - 1);
         redoItems.back().redo(this, activeView());
         undoItems.push_back(std::move(redoItems.back()));
         redoItems.pop_back();
@@ -485,7 +543,9 @@ void KateUndoManager::updateModified()
 
 void KateUndoManager::clearUndo()
 {
+    m_memoryUsage -= memoryUsageOf(undoItems);
     undoItems.clear();
+    m_undoLineIndex = {};
 
     lastUndoGroupWhenSaved = nullptr;
     docWasSavedWhenUndoWasEmpty = false;
@@ -495,7 +555,9 @@ void KateUndoManager::clearUndo()
 
 void KateUndoManager::clearRedo()
 {
+    m_memoryUsage -= memoryUsageOf(redoItems);
     redoItems.clear();
+    m_redoLineIndex = {};
 
     lastRedoGroupWhenSaved = nullptr;
     docWasSavedWhenRedoWasEmpty = false;
@@ -521,44 +583,132 @@ void KateUndoManager::setModified(bool modified)
 
 void KateUndoManager::updateLineModifications()
 {
-    // change LineSaved flag of all undo & redo items to LineModified
-    for (KateUndoGroup &undoGroup : undoItems) {
-        undoGroup.flagSavedAsModified();
+    // the undo stack is marked from the newest group, to find out which item sets the flag LineSaved on redo
+    markAsSaved(undoItems, m_undoLineIndex, true);
+
+    // the redo stack from the group to redo next
+    markAsSaved(redoItems, m_redoLineIndex, false);
+}
+
+void KateUndoManager::groupChanged(const std::deque<KateUndoGroup> &stack, LineModificationIndex &index, size_t position)
+{
+    // the newest groups leave the unchanged part, they are at the end of the per line lists
+    while (index.unchanged > position) {
+        --index.unchanged;
+        const KateUndoGroup &group = stack[index.unchanged];
+        const qint64 id = index.dropped + qint64(index.unchanged);
+        for (int i = 0; i < group.itemCount(); ++i) {
+            const auto it = index.items.find(group.itemLine(i));
+            if (it == index.items.end()) {
+                continue;
+            }
+            while (!it->empty() && it->back().group == id) {
+                it->pop_back();
+            }
+            if (it->empty()) {
+                index.items.erase(it);
+            }
+        }
+        group.touchedLines(index.dirtyLines);
+    }
+}
+
+void KateUndoManager::groupsDropped(const std::deque<KateUndoGroup> &stack, LineModificationIndex &index, size_t count)
+{
+    // nothing is older than the dropped groups, so no other item changes, they are at the front of the per line lists
+    for (size_t g = 0; g < count && g < index.unchanged; ++g) {
+        const KateUndoGroup &group = stack[g];
+        const qint64 id = index.dropped + qint64(g);
+        for (int i = 0; i < group.itemCount(); ++i) {
+            const auto it = index.items.find(group.itemLine(i));
+            if (it == index.items.end()) {
+                continue;
+            }
+            const auto end = std::find_if(it->begin(), it->end(), [id](const auto &ref) {
+                return ref.group != id;
+            });
+            it->erase(it->begin(), end);
+            if (it->empty()) {
+                index.items.erase(it);
+            }
+        }
     }
 
-    for (KateUndoGroup &undoGroup : redoItems) {
-        undoGroup.flagSavedAsModified();
+    index.unchanged -= std::min(count, index.unchanged);
+    index.dropped += qint64(count);
+}
+
+void KateUndoManager::markAsSaved(std::deque<KateUndoGroup> &stack, LineModificationIndex &index, bool undoStack)
+{
+    // all changed groups get new flags, newest first
+    QBitArray lines;
+    QSet<int> affected = std::move(index.dirtyLines);
+    index.dirtyLines.clear();
+    for (size_t g = stack.size(); g-- > index.unchanged;) {
+        KateUndoGroup &group = stack[g];
+        group.flagSavedAsModified();
+        if (undoStack) {
+            group.markRedoAsSaved(lines);
+        } else {
+            group.markUndoAsSaved(lines);
+        }
+        group.touchedLines(affected);
     }
 
-    // iterate all undo/redo items to find out, which item sets the flag LineSaved
-    QBitArray lines(document()->lines(), false);
-    for (int i = undoItems.size() - 1; i >= 0; --i) {
-        undoItems[i].markRedoAsSaved(lines);
+    // an unchanged item only depends on the flags of newer items on its line and the next one:
+    // update the ones on affected lines, the ones two lines around only tell which lines are taken
+    if (!affected.isEmpty() && !index.items.isEmpty()) {
+        QSet<int> candidates;
+        for (const int line : std::as_const(affected)) {
+            for (int l = line - 2; l <= line + 1; ++l) {
+                candidates.insert(l);
+            }
+        }
+
+        std::vector<LineModificationIndex::ItemRef> refs;
+        for (const int line : std::as_const(candidates)) {
+            const auto it = index.items.constFind(line);
+            if (it != index.items.cend()) {
+                refs.insert(refs.end(), it->begin(), it->end());
+            }
+        }
+        std::sort(refs.begin(), refs.end(), [](const auto &a, const auto &b) {
+            return a.group > b.group || (a.group == b.group && a.item > b.item);
+        });
+
+        for (const auto &ref : refs) {
+            KateUndoGroup &group = stack[size_t(ref.group - index.dropped)];
+            const int line = group.itemLine(ref.item);
+            const bool apply = affected.contains(line) || affected.contains(line + 1);
+            if (undoStack) {
+                group.markItemRedoAsSaved(ref.item, lines, apply);
+            } else {
+                group.markItemUndoAsSaved(ref.item, lines, apply);
+            }
+        }
     }
 
-    lines.fill(false);
-    for (int i = redoItems.size() - 1; i >= 0; --i) {
-        redoItems[i].markUndoAsSaved(lines);
+    // the changed groups are unchanged from now on
+    for (size_t g = index.unchanged; g < stack.size(); ++g) {
+        const KateUndoGroup &group = stack[g];
+        const qint64 id = index.dropped + qint64(g);
+        for (int i = 0; i < group.itemCount(); ++i) {
+            index.items[group.itemLine(i)].push_back({id, i});
+        }
     }
+    index.unchanged = stack.size();
 }
 
-void KateUndoManager::setUndoRedoCursorsOfLastGroup(const KTextEditor::Cursor undoCursor, const KTextEditor::Cursor redoCursor)
+void KateUndoManager::recoveryStart()
 {
-    Q_ASSERT(!m_editCurrentUndo.has_value());
-    if (!undoItems.empty()) {
-        KateUndoGroup &last = undoItems.back();
-        last.setUndoCursor(undoCursor);
-        last.setRedoCursor(redoCursor);
-    }
+    setActive(false);
+    m_document->editStart();
 }
 
-KTextEditor::Cursor KateUndoManager::lastRedoCursor() const
+void KateUndoManager::recoveryEnd()
 {
-    Q_ASSERT(!m_editCurrentUndo.has_value());
-    if (!undoItems.empty()) {
-        undoItems.back().redoCursor();
-    }
-    return KTextEditor::Cursor::invalid();
+    m_document->editEnd();
+    setActive(true);
 }
 
 void KateUndoManager::updateConfig()
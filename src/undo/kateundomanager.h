@@ -12,8 +12,11 @@
 
 #include <ktexteditor_export.h>
 
+#include <QHash>
 #include <QList>
+#include <QSet>
 
+#include <deque>
 #include <optional>
 
 namespace KTextEditor
@@ -93,22 +96,28 @@ public:
 
     void setModified(bool modified);
     void updateConfig();
+
+    /**
+     * Approximate memory used by the undo and redo history in bytes.
+     * Limited by the "Undo Memory Limit" config entry, the oldest groups are dropped if needed.
+     */
+    qsizetype memoryUsage() const
+    {
+        return m_memoryUsage;
+    }
     KTEXTEDITOR_EXPORT void updateLineModifications();
 
     /**
-     * Used by the swap file recovery, this function afterwards manipulates
-     * the undo/redo cursors of the last KateUndoGroup.
+     * Used by the swap file recovery, replays all recorded edits in one
+     * editing transaction without creating undo items.
      * This function should not be used other than by Kate::SwapFile.
-     * @param undoCursor the undo cursor
-     * @param redoCursor the redo cursor
      */
-    void setUndoRedoCursorsOfLastGroup(const KTextEditor::Cursor undoCursor, const KTextEditor::Cursor redoCursor);
+    void recoveryStart();
 
     /**
-     * Returns the redo cursor of the last undo group.
-     * Needed for the swap file recovery.
+     * End of the swap file recovery, see recoveryStart().
      */
-    KTextEditor::Cursor lastRedoCursor() const;
+    void recoveryEnd();
 
 public Q_SLOTS:
     /**
@@ -193,7 +202,7 @@ private Q_SLOTS:
      *
      * @param undo undo item to be added, must be non-null
      */
-    void addUndoItem(UndoItem undo);
+    void addUndoItem(UndoItem undo, const QString &text = QString());
 
     void setActive(bool active);
 
@@ -206,13 +215,59 @@ private:
     KTEXTEDITOR_NO_EXPORT
     KTextEditor::ViewPrivate *activeView();
 
+    /**
+     * Drop the oldest undo groups until we are within the configured memory limit.
+     */
+    void trimUndoHistory();
+
+    /**
+     * Line modification state of one undo or redo stack, as of the last updateLineModifications().
+     * The groups [0, unchanged) of the stack did not change since then, only the changed groups
+     * and the unchanged items on lines near them need a new saved/modified flag.
+     */
+    struct LineModificationIndex {
+        struct ItemRef {
+            // position in the stack + dropped
+            qint64 group;
+            int item;
+        };
+
+        size_t unchanged = 0;
+        qint64 dropped = 0;
+
+        // lines touched by groups that left the unchanged part
+        QSet<int> dirtyLines;
+
+        // items of the unchanged groups by line, oldest first
+        QHash<int, std::vector<ItemRef>> items;
+    };
+
+    /**
+     * The group at @p position of the stack is about to change or be removed.
+     */
+    static void groupChanged(const std::deque<KateUndoGroup> &stack, LineModificationIndex &index, size_t position);
+
+    /**
+     * The @p count oldest groups of the stack are about to be dropped.
+     */
+    static void groupsDropped(const std::deque<KateUndoGroup> &stack, LineModificationIndex &index, size_t count);
+
+    /**
+     * Update the flags of all groups of the stack changed since the last call and of the unchanged items on their lines.
+     */
+    static void markAsSaved(std::deque<KateUndoGroup> &stack, LineModificationIndex &index, bool undoStack);
+
 private:
     KTextEditor::DocumentPrivate *m_document = nullptr;
     bool m_undoComplexMerge = false;
     bool m_isActive = true;
     std::optional<KateUndoGroup> m_editCurrentUndo;
-    std::vector<KateUndoGroup> undoItems;
-    std::vector<KateUndoGroup> redoItems;
+    // deque: pointers to the groups stay valid if we add groups or drop the oldest ones
+    std::deque<KateUndoGroup> undoItems;
+    std::deque<KateUndoGroup> redoItems;
+    qsizetype m_memoryUsage = 0;
+    LineModificationIndex m_undoLineIndex;
+    LineModificationIndex m_redoLineIndex;
     // these two variables are for resetting the document to
     // non-modified if all changes have been undone...
     KateUndoGroup *lastUndoGroupWhenSaved = nullptr;
@@ -221,8 +276,8 @@ private:
     bool docWasSavedWhenRedoWasEmpty = true;
 
     // saved undo items that are used to restore state on doc reload
-    std::vector<KateUndoGroup> savedUndoItems;
-    std::vector<KateUndoGroup> savedRedoItems;
+    std::deque<KateUndoGroup> savedUndoItems;
+    std::deque<KateUndoGroup> savedRedoItems;
     QByteArray docChecksumBeforeReload;
 };
 
@@ -14,6 +14,7 @@
 #include "kateautoindent.h"
 
 #include "attribute.h"
+#include "katebuffer.h"
 #include "katedocument.h"
 #include "kateglobal.h"
 #include "katehighlight.h"
@@ -270,6 +271,15 @@ void KateAutoIndent::scriptIndent(KTextEditor::ViewPrivate *view, const KTextEdi
     doc->editStart();
 
     QPair<int, int> result = m_script->indent(view, position, typedChar, indentWidth);
+    applyScriptIndent(position.line(), result);
+
+    // end edit in all cases
+    doc->editEnd();
+    doc->popEditState();
+}
+
+void KateAutoIndent::applyScriptIndent(int line, QPair<int, int> result)
+{
     int newIndentInChars = result.first;
 
     // handle negative values special
@@ -280,18 +290,14 @@ void KateAutoIndent::scriptIndent(KTextEditor::ViewPrivate *view, const KTextEdi
     // reuse indentation of the previous line, just like the "normal" indenter
     else if (newIndentInChars == -1) {
         // keep indent of previous line
-        keepIndent(position.line());
+        keepIndent(line);
     }
 
     // get align
     else {
         // we got a positive or zero indent to use...
-        doIndent(position.line(), newIndentInChars, result.second);
+        doIndent(line, newIndentInChars, result.second);
     }
-
-    // end edit in all cases
-    doc->editEnd();
-    doc->popEditState();
 }
 
 bool KateAutoIndent::isStyleProvided(const KateIndentScript *script, const KateHighlighting *highlight)
@@ -403,11 +409,29 @@ void KateAutoIndent::indent(KTextEditor::ViewPrivate *view, KTextEditor::Range r
 
     bool prevKeepExtra = keepExtra;
     keepExtra = false; // we are formatting a block of code, no extra spaces
-    // loop over all lines given...
-    for (int line = range.start().line() < 0 ? 0 : range.start().line(); line <= qMin(range.end().line(), doc->lines() - 1); ++line) {
-        // let the script indent for us...
-        scriptIndent(view, KTextEditor::Cursor(line, 0), QChar());
-    }
+
+    // one call into the script for all lines given, all changes in one editing transaction
+    doc->pushEditState();
+    doc->editStart();
+
+    const int startLine = qMax(range.start().line(), 0);
+    const int endLine = qMin(range.end().line(), doc->lines() - 1);
+    m_script->indentLines(view, startLine, endLine, indentWidth, [this](int line, QPair<int, int> result) {
+        if (line < 0 || line >= doc->lines()) {
+            return;
+        }
+
+        const qint64 revision = doc->buffer().revision();
+        applyScriptIndent(line, result);
+
+        // the script looks at the attributes of the lines in front when indenting the next one
+        if (doc->buffer().revision() != revision) {
+            doc->buffer().rehighlightLine(line);
+        }
+    });
+
+    doc->editEnd();
+    doc->popEditState();
 
     keepExtra = prevKeepExtra;
     // we want one undo action => END
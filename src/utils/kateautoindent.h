@@ -145,6 +145,13 @@ private:
      */
     void scriptIndent(KTextEditor::ViewPrivate *view, const KTextEditor::Cursor position, QChar typedChar);
 
+    /**
+     * Apply the indentation computed by the indentation script
+     * \param line line to change indent for
+     * \param result indent and align as returned by the script
+     */
+    void applyScriptIndent(int line, QPair<int, int> result);
+
     /**
      * Return true if the required style for the script is provided by the highlighter.
      */
@@ -351,6 +351,9 @@ KateDocumentConfig::KateDocumentConfig()
     addConfigEntry(ConfigEntry(SwapFileDirectory, "Swap Directory", QString(), QString()));
     addConfigEntry(ConfigEntry(SwapFileSyncInterval, "Swap Sync Interval", QString(), 15));
     addConfigEntry(ConfigEntry(LineLengthLimit, "Line Length Limit", QString(), 10000));
+    addConfigEntry(ConfigEntry(UndoMemoryLimit, "Undo Memory Limit", QString(), 256, [](const QVariant &value) {
+        return value.toInt() >= 0;
+    }));
     addConfigEntry(ConfigEntry(CamelCursor, "Camel Cursor", QString(), true));
     addConfigEntry(ConfigEntry(AutoDetectIndent, "Auto Detect Indent", QString(), true));
 
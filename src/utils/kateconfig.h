@@ -514,6 +514,11 @@ public:
          */
         LineLengthLimit,
 
+        /**
+         * Memory budget of the undo history in MiB, 0 for unlimited
+         */
+        UndoMemoryLimit,
+
         /**
          * Camel Cursor Movement?
          */
@@ -915,6 +920,11 @@ public:
         return value(LineLengthLimit).toInt();
     }
 
+    int undoMemoryLimit() const
+    {
+        return value(UndoMemoryLimit).toInt();
+    }
+
     void setLineLengthLimit(int limit)
     {
         setValue(LineLengthLimit, limit);
@@ -26,6 +26,8 @@
 #include "katemodemanager.h"
 #include "katescriptmanager.h"
 #include "katesedcmd.h"
+#include "katesharedwordindex.h"
+#include "kateswapfilewriter.h"
 #include "katesyntaxmanager.h"
 #include "katethemeconfig.h"
 #include "katevariableexpansionmanager.h"
@@ -202,6 +204,9 @@ KTextEditor::EditorPrivate::EditorPrivate(QPointer<KTextEditor::EditorPrivate> &
     // global word completion model
     m_wordCompletionModel = new KateWordCompletionModel(this);
 
+    // words of all documents, for the word completion
+    m_sharedWordIndex = new KateSharedWordIndex(this);
+
     // global keyword completion model
     m_keywordCompletionModel = new KateKeywordCompletionModel(this);
 
@@ -211,6 +216,9 @@ KTextEditor::EditorPrivate::EditorPrivate(QPointer<KTextEditor::EditorPrivate> &
 
 KTextEditor::EditorPrivate::~EditorPrivate()
 {
+    // finish pending swap file writes while the application is still there
+    delete m_swapFileWriter;
+
     delete m_globalConfig;
     delete m_documentConfig;
     delete m_viewConfig;
@@ -407,6 +415,7 @@ void KTextEditor::EditorPrivate::registerDocument(KTextEditor::DocumentPrivate *
 {
     Q_ASSERT(!m_documents.contains(doc));
     m_documents.push_back(doc);
+    m_sharedWordIndex->addDocument(doc);
 }
 
 void KTextEditor::EditorPrivate::deregisterDocument(KTextEditor::DocumentPrivate *doc)
@@ -569,6 +578,14 @@ void KTextEditor::EditorPrivate::emitConfigChanged()
     }
 }
 
+Kate::SwapFileWriter *KTextEditor::EditorPrivate::swapFileWriter()
+{
+    if (!m_swapFileWriter) {
+        m_swapFileWriter = new Kate::SwapFileWriter();
+    }
+    return m_swapFileWriter;
+}
+
 QTextToSpeech *KTextEditor::EditorPrivate::speechEngine(KTextEditor::ViewPrivate *view)
 {
     Q_ASSERT(view);
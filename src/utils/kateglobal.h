@@ -48,9 +48,14 @@ class KDirWatch;
 class KateHlManager;
 class KateSpellCheckManager;
 class KateWordCompletionModel;
+class KateSharedWordIndex;
 class KateAbstractInputModeFactory;
 class KateKeywordCompletionModel;
 class KateVariableExpansionManager;
+namespace Kate
+{
+class SwapFileWriter;
+}
 
 namespace KTextEditor
 {
@@ -302,6 +307,15 @@ public:
         return m_wordCompletionModel;
     }
 
+    /**
+     * Words of all documents, for word completion across documents
+     * @return global word index
+     */
+    KateSharedWordIndex *sharedWordIndex()
+    {
+        return m_sharedWordIndex;
+    }
+
     /**
      * Global instance of the language-aware keyword completion model
      * @return global instance of the keyword completion model
@@ -415,6 +429,12 @@ public:
      */
     QTextToSpeech *speechEngine(KTextEditor::ViewPrivate *view);
 
+    /**
+     * thread writing the swap files of all documents, constructed on demand.
+     * Finishes all pending writes before the editor goes away.
+     */
+    Kate::SwapFileWriter *swapFileWriter();
+
 private Q_SLOTS:
     /**
      * Emit configChanged if needed.
@@ -527,6 +547,11 @@ private:
      */
     KateWordCompletionModel *m_wordCompletionModel;
 
+    /**
+     * words of all documents
+     */
+    KateSharedWordIndex *m_sharedWordIndex;
+
     /**
      * global instance of the language-specific keyword completion model
      */
@@ -582,6 +607,11 @@ private:
      * used to show error messages and to stop output on view destruction
      */
     QPointer<KTextEditor::ViewPrivate> m_speechEngineLastUser;
+
+    /**
+     * swap file writer thread, constructed on demand
+     */
+    Kate::SwapFileWriter *m_swapFileWriter = nullptr;
 };
 
 }
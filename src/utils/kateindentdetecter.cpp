@@ -5,10 +5,18 @@
 */
 #include "kateindentdetecter.h"
 
+#include "katebuffer.h"
 #include "katedocument.h"
 
+#include <vector>
+
 KateIndentDetecter::KateIndentDetecter(KTextEditor::DocumentPrivate *doc)
-    : m_doc(doc)
+    : m_snapshot(doc->buffer().snapshot())
+{
+}
+
+KateIndentDetecter::KateIndentDetecter(const Kate::TextSnapshot &snapshot)
+    : m_snapshot(snapshot)
 {
 }
 
@@ -97,8 +105,24 @@ static SpacesDiffResult spacesDiff(const QString &a, int aLength, const QString
 
 KateIndentDetecter::Result KateIndentDetecter::detect(int defaultTabSize, bool defaultInsertSpaces)
 {
-    // Look at most at the first 10k lines
-    const int linesCount = std::min(m_doc->lines(), 10000);
+    // Look at most at 10k lines: all of a small file, else the head and windows spread over the rest.
+    // The lines of a window are consecutive, indentation differences are only taken within a window.
+    struct Window {
+        int start;
+        int count;
+    };
+    std::vector<Window> windows;
+    const int lines = m_snapshot.lines();
+    if (lines <= MaxLines) {
+        windows.push_back({0, lines});
+    } else {
+        windows.push_back({0, HeadLines});
+        const int windowLines = (MaxLines - HeadLines) / SampleWindows;
+        const qint64 stride = (qint64(lines) - HeadLines) / SampleWindows;
+        for (int i = 0; i < SampleWindows; ++i) {
+            windows.push_back({int(HeadLines + i * stride), windowLines});
+        }
+    }
 
     int linesIndentedWithTabsCount = 0; // number of lines that contain at least one tab in indentation
     int linesIndentedWithSpacesCount = 0; // number of lines that contain only spaces in indentation
@@ -112,65 +136,70 @@ KateIndentDetecter::Result KateIndentDetecter::detect(int defaultTabSize, bool d
     int spacesDiffCount[MAX_ALLOWED_TAB_SIZE_GUESS + 1] = {0, 0, 0, 0, 0, 0, 0, 0, 0}; // `tabSize` scores
     SpacesDiffResult tmp;
 
-    for (int lineNumber = 0; lineNumber < linesCount; lineNumber++) {
-        const QString currentLineText = m_doc->line(lineNumber);
-        const int currentLineLength = currentLineText.length();
-
-        bool currentLineHasContent = false; // does `currentLineText` contain non-whitespace chars
-        int currentLineIndentation = 0; // index at which `currentLineText` contains the first non-whitespace char
-        int currentLineSpacesCount = 0; // count of spaces found in `currentLineText` indentation
-        int currentLineTabsCount = 0; // count of tabs found in `currentLineText` indentation
-        for (int j = 0, lenJ = currentLineLength; j < lenJ; j++) {
-            const auto charCode = currentLineText.at(j);
-
-            if (charCode == QLatin1Char('\t')) {
-                currentLineTabsCount++;
-            } else if (charCode == QLatin1Char(' ')) {
-                currentLineSpacesCount++;
-            } else {
-                // Hit non whitespace character on this line
-                currentLineHasContent = true;
-                currentLineIndentation = j;
-                break;
+    for (const Window &window : windows) {
+        previousLineText.clear();
+        previousLineIndentation = 0;
+        for (int lineNumber = window.start; lineNumber < window.start + window.count; lineNumber++) {
+            // shares the text with the buffer, no copy
+            const QString currentLineText = m_snapshot.lineText(lineNumber);
+            const int currentLineLength = currentLineText.length();
+
+            bool currentLineHasContent = false; // does `currentLineText` contain non-whitespace chars
+            int currentLineIndentation = 0; // index at which `currentLineText` contains the first non-whitespace char
+            int currentLineSpacesCount = 0; // count of spaces found in `currentLineText` indentation
+            int currentLineTabsCount = 0; // count of tabs found in `currentLineText` indentation
+            for (int j = 0, lenJ = currentLineLength; j < lenJ; j++) {
+                const auto charCode = currentLineText.at(j);
+
+                if (charCode == QLatin1Char('\t')) {
+                    currentLineTabsCount++;
+                } else if (charCode == QLatin1Char(' ')) {
+                    currentLineSpacesCount++;
+                } else {
+                    // Hit non whitespace character on this line
+                    currentLineHasContent = true;
+                    currentLineIndentation = j;
+                    break;
+                }
             }
-        }
-
-        // Ignore empty or only whitespace lines
-        if (!currentLineHasContent) {
-            continue;
-        }
 
-        if (currentLineTabsCount > 0) {
-            linesIndentedWithTabsCount++;
-        } else if (currentLineSpacesCount > 1) {
-            linesIndentedWithSpacesCount++;
-        }
+            // Ignore empty or only whitespace lines
+            if (!currentLineHasContent) {
+                continue;
+            }
 
-        tmp = spacesDiff(previousLineText, previousLineIndentation, currentLineText, currentLineIndentation);
+            if (currentLineTabsCount > 0) {
+                linesIndentedWithTabsCount++;
+            } else if (currentLineSpacesCount > 1) {
+                linesIndentedWithSpacesCount++;
+            }
 
-        if (tmp.looksLikeAlignment) {
-            // if defaultInsertSpaces === true && the spaces count == tabSize, we may want to count it as valid indentation
-            //
-            // - item1
-            //   - item2
-            //
-            // otherwise skip this line entirely
-            //
-            // const a = 1,
-            //       b = 2;
+            tmp = spacesDiff(previousLineText, previousLineIndentation, currentLineText, currentLineIndentation);
+
+            if (tmp.looksLikeAlignment) {
+                // if defaultInsertSpaces === true && the spaces count == tabSize, we may want to count it as valid indentation
+                //
+                // - item1
+                //   - item2
+                //
+                // otherwise skip this line entirely
+                //
+                // const a = 1,
+                //       b = 2;
+
+                if (!(defaultInsertSpaces && defaultTabSize == tmp.spacesDiff)) {
+                    continue;
+                }
+            }
 
-            if (!(defaultInsertSpaces && defaultTabSize == tmp.spacesDiff)) {
-                continue;
+            const int currentSpacesDiff = tmp.spacesDiff;
+            if (currentSpacesDiff <= MAX_ALLOWED_TAB_SIZE_GUESS) {
+                spacesDiffCount[currentSpacesDiff]++;
             }
-        }
 
-        const int currentSpacesDiff = tmp.spacesDiff;
-        if (currentSpacesDiff <= MAX_ALLOWED_TAB_SIZE_GUESS) {
-            spacesDiffCount[currentSpacesDiff]++;
+            previousLineText = currentLineText;
+            previousLineIndentation = currentLineIndentation;
         }
-
-        previousLineText = currentLineText;
-        previousLineIndentation = currentLineIndentation;
     }
 
     bool insertSpaces = defaultInsertSpaces;
@@ -6,6 +6,8 @@
 #ifndef KATE_INDENT_DETECTER_H
 #define KATE_INDENT_DETECTER_H
 
+#include "katetextsnapshot.h"
+
 namespace KTextEditor
 {
 class DocumentPrivate;
@@ -13,6 +15,10 @@ class DocumentPrivate;
 
 /**
  * File indentation detecter. Mostly ported from VSCode to here
+ *
+ * Works on a snapshot of the buffer, so it can run in any thread.
+ * Large files are sampled across their whole length, a license header
+ * in a different style doesn't decide the result alone.
  */
 class KateIndentDetecter
 {
@@ -29,11 +35,23 @@ public:
     };
 
     KateIndentDetecter(KTextEditor::DocumentPrivate *doc);
+    explicit KateIndentDetecter(const Kate::TextSnapshot &snapshot);
 
     Result detect(int defaultTabSize, bool defaultInsertSpaces);
 
+    /**
+     * At most that many lines are looked at.
+     */
+    static constexpr int MaxLines = 10000;
+
+    /**
+     * Files with more lines are sampled: the first lines and windows of consecutive lines spread over the rest.
+     */
+    static constexpr int HeadLines = 2000;
+    static constexpr int SampleWindows = 16;
+
 private:
-    KTextEditor::DocumentPrivate *m_doc;
+    Kate::TextSnapshot m_snapshot;
 };
 
 #endif
@@ -1489,19 +1489,44 @@ void KTextEditor::ViewPrivate::setupSpeechActions()
 
 void KTextEditor::ViewPrivate::slotFoldToplevelNodes()
 {
-    for (int line = 0; line < doc()->lines(); ++line) {
-        if (textFolding().isLineVisible(line)) {
-            foldLine(line);
+    // compute all foldings in one sweep, fold the ones on visible lines like foldLine() would do, and add them at once
+    QList<KTextEditor::Range> toplevelRanges;
+    int hiddenUntilLine = -1;
+    const auto foldingRanges = doc()->buffer().computeFoldingRanges();
+    for (auto [foldingRange, indentationBased] : foldingRanges) {
+        // skip lines hidden by the ranges we fold or already folded ones
+        const int line = foldingRange.start().line();
+        if (line <= hiddenUntilLine || !textFolding().isLineVisible(line)) {
+            continue;
+        }
+
+        // Ensure not to fold the end marker to avoid a deceptive look, but only on token based folding
+        if (!indentationBased && !foldingRange.onSingleLine()) {
+            const int adjustedLine = foldingRange.end().line() - 1;
+            foldingRange.setEnd(KTextEditor::Cursor(adjustedLine, doc()->buffer().plainLine(adjustedLine).length()));
+        }
+
+        // Don't fold a single line or a range that is already there
+        if (foldingRange.onSingleLine()) {
+            continue;
         }
+        const auto folds = textFolding().foldingRangesStartingOnLine(line);
+        if (std::any_of(folds.cbegin(), folds.cend(), [this, foldingRange](const auto &fold) {
+                return textFolding().foldingRange(fold.first) == foldingRange;
+            })) {
+            continue;
+        }
+
+        toplevelRanges.push_back(foldingRange);
+        hiddenUntilLine = foldingRange.end().line();
     }
+
+    textFolding().newFoldingRanges(toplevelRanges, Kate::TextFolding::Folded);
 }
 
 void KTextEditor::ViewPrivate::slotExpandToplevelNodes()
 {
-    const auto topLevelRanges(textFolding().foldingRangesForParentRange());
-    for (const auto &range : topLevelRanges) {
-        textFolding().unfoldRange(range.first);
-    }
+    textFolding().unfoldToplevelRanges();
 }
 
 void KTextEditor::ViewPrivate::slotToggleFolding()
@@ -4893,6 +4918,7 @@ void KTextEditor::ViewPrivate::slotDelayedUpdateOfView()
     if (m_lineToUpdateRange.isValid()) {
         tagLines(m_lineToUpdateRange, true);
         updateView(true);
+        m_viewInternal->m_lineScroll->queuePixmapUpdate(m_lineToUpdateRange);
     }
 
     // reset flags
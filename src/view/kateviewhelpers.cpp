@@ -210,13 +210,23 @@ void KateScrollBar::setShowMiniMap(bool b)
 {
     if (b && !m_showMiniMap) {
         auto timerSlot = qOverload<>(&QTimer::start);
+        // the changed lines of edits are passed in via queuePixmapUpdate(LineRange), see KateViewInternal::editEnd
+        // selection changes are diffed against the last painted selection in updatePixmap()
         connect(m_view, &KTextEditor::ViewPrivate::selectionChanged, &m_updateTimer, timerSlot, Qt::UniqueConnection);
-        connect(m_doc, &KTextEditor::DocumentPrivate::textChanged, &m_updateTimer, timerSlot, Qt::UniqueConnection);
-        connect(m_view, &KTextEditor::ViewPrivate::delayedUpdateOfView, &m_updateTimer, timerSlot, Qt::UniqueConnection);
+        connect(&m_doc->buffer(), &KateBuffer::tagLines, this, qOverload<KTextEditor::LineRange>(&KateScrollBar::queuePixmapUpdate), Qt::UniqueConnection);
         connect(&m_updateTimer, &QTimer::timeout, this, &KateScrollBar::updatePixmap, Qt::UniqueConnection);
-        connect(&(m_view->textFolding()), &Kate::TextFolding::foldingRangesChanged, &m_updateTimer, timerSlot, Qt::UniqueConnection);
+        connect(&(m_view->textFolding()),
+                &Kate::TextFolding::foldingRangesChanged,
+                this,
+                qOverload<>(&KateScrollBar::queuePixmapUpdate),
+                Qt::UniqueConnection);
+
+        // we did not track any changes while hidden
+        m_needsFullPixmapUpdate = true;
     } else if (!b) {
         disconnect(&m_updateTimer);
+        disconnect(&m_doc->buffer(), &KateBuffer::tagLines, this, nullptr);
+        disconnect(&(m_view->textFolding()), &Kate::TextFolding::foldingRangesChanged, this, nullptr);
     }
 
     m_showMiniMap = b;
@@ -536,31 +546,47 @@ void KateScrollBar::getCharColorRanges(const QList<Kate::TextLine::Attribute> &a
     }
 }
 
-void KateScrollBar::updatePixmap()
+void KateScrollBar::queuePixmapUpdate(KTextEditor::LineRange lineRange)
 {
-    // QElapsedTimer time;
-    // time.start();
-
-    if (!m_showMiniMap) {
-        // make sure no time is wasted if the option is disabled
+    if (!m_showMiniMap || !lineRange.isValid()) {
         return;
     }
 
-    if (!isVisible()) {
-        // don't update now if the document is not visible; do it when
-        // the document is shown again instead
-        m_needsUpdateOnShow = true;
-        return;
+    m_dirtyLines = m_dirtyLines.encompass(lineRange);
+    m_updateTimer.start();
+}
+
+void KateScrollBar::markSelectionDirty(KTextEditor::Range oldSelection, KTextEditor::Range newSelection)
+{
+    // same logic as in ViewPrivate::tagSelection, only the moved boundary needs a repaint
+    const bool hadSelection = oldSelection.isValid() && !oldSelection.isEmpty();
+    const bool hasSelection = newSelection.isValid() && !newSelection.isEmpty();
+    if (hadSelection && hasSelection && oldSelection.start() == newSelection.start()) {
+        m_dirtyLines = m_dirtyLines.encompass(KTextEditor::LineRange(oldSelection.end().line(), newSelection.end().line()));
+    } else if (hadSelection && hasSelection && oldSelection.end() == newSelection.end()) {
+        m_dirtyLines = m_dirtyLines.encompass(KTextEditor::LineRange(oldSelection.start().line(), newSelection.start().line()));
+    } else {
+        if (hadSelection) {
+            m_dirtyLines = m_dirtyLines.encompass(KTextEditor::LineRange(oldSelection.start().line(), oldSelection.end().line()));
+        }
+        if (hasSelection) {
+            m_dirtyLines = m_dirtyLines.encompass(KTextEditor::LineRange(newSelection.start().line(), newSelection.end().line()));
+        }
     }
+}
+
+KateScrollBar::MiniMapLayout KateScrollBar::computeMiniMapLayout()
+{
+    MiniMapLayout layout;
 
     // For performance reason, only every n-th line will be drawn if the widget is
     // sufficiently small compared to the amount of lines in the document.
-    int docLineCount = m_view->textFolding().visibleLines();
-    int pixmapLineCount = docLineCount;
+    layout.docLineCount = m_view->textFolding().visibleLines();
+    int pixmapLineCount = layout.docLineCount;
     if (m_view->config()->scrollPastEnd()) {
         pixmapLineCount += pageStep();
     }
-    int pixmapLinesUnscaled = pixmapLineCount;
+    layout.pixmapLinesUnscaled = pixmapLineCount;
     if (m_grooveHeight < 5) {
         m_grooveHeight = 5;
     }
@@ -570,16 +596,108 @@ void KateScrollBar::updatePixmap()
         charIncrement = pixmapLineCount / m_grooveHeight;
         while (charIncrement > s_linePixelIncLimit) {
             lineIncrement++;
-            pixmapLineCount = pixmapLinesUnscaled / lineIncrement;
+            pixmapLineCount = layout.pixmapLinesUnscaled / lineIncrement;
             charIncrement = pixmapLineCount / m_grooveHeight;
         }
         pixmapLineCount /= charIncrement;
     }
 
-    int pixmapLineWidth = s_pixelMargin + s_lineWidth / charIncrement;
+    layout.pixmapLineCount = pixmapLineCount;
+    layout.lineIncrement = lineIncrement;
+    layout.charIncrement = charIncrement;
+    layout.pixmapLineWidth = s_pixelMargin + s_lineWidth / charIncrement;
+    layout.devicePixelRatio = m_view->devicePixelRatioF();
 
     // qCDebug(LOG_KTE) << "l" << lineIncrement << "c" << charIncrement << "d";
-    // qCDebug(LOG_KTE) << "pixmap" << pixmapLineCount << pixmapLineWidth << "docLines" << m_view->textFolding().visibleLines() << "height" << m_grooveHeight;
+    // qCDebug(LOG_KTE) << "pixmap" << pixmapLineCount << layout.pixmapLineWidth << "docLines" << layout.docLineCount << "height" << m_grooveHeight;
+    return layout;
+}
+
+void KateScrollBar::updatePixmap()
+{
+    // QElapsedTimer time;
+    // time.start();
+
+    if (!m_showMiniMap) {
+        // make sure no time is wasted if the option is disabled
+        return;
+    }
+
+    if (!isVisible()) {
+        // don't update now if the document is not visible; do it when
+        // the document is shown again instead
+        m_needsUpdateOnShow = true;
+        return;
+    }
+
+    const MiniMapLayout layout = computeMiniMapLayout();
+
+    // only repaint what changed if the geometry of the pixmap is still the same
+    const KTextEditor::Range selection = m_view->selectionRange();
+    if (selection != m_pixmapSelection) {
+        markSelectionDirty(m_pixmapSelection, selection);
+    }
+    const bool fullUpdate = m_needsFullPixmapUpdate || m_pixmap.isNull() || layout != m_pixmapLayout;
+
+    int firstRow = 0;
+    int lastRow = layout.pixmapLineCount - 1;
+    if (!fullUpdate) {
+        if (!m_dirtyLines.isValid()) {
+            // nothing visible did change
+            m_pixmapSelection = selection;
+            return;
+        }
+
+        // map the changed document lines to the pixmap rows they are painted into
+        const int lastVisibleLine = qMax(0, layout.docLineCount - 1);
+        const int firstLine = qBound(0, m_view->textFolding().lineToVisibleLine(m_dirtyLines.start()), lastVisibleLine);
+        const int lastLine = qBound(0, m_view->textFolding().lineToVisibleLine(m_dirtyLines.end()), lastVisibleLine);
+        firstRow = (firstLine / layout.lineIncrement) / layout.charIncrement;
+        lastRow = qMin((lastLine / layout.lineIncrement) / layout.charIncrement, layout.pixmapLineCount - 1);
+    }
+
+    m_needsFullPixmapUpdate = false;
+    m_dirtyLines = KTextEditor::LineRange::invalid();
+    m_pixmapSelection = selection;
+    m_pixmapLayout = layout;
+
+    if (fullUpdate) {
+        // increase dimensions by ratio
+        m_pixmap = QPixmap(layout.pixmapLineWidth * layout.devicePixelRatio, layout.pixmapLineCount * layout.devicePixelRatio);
+        m_pixmap.fill(QColor("transparent"));
+    } else {
+        // paint in device pixels, like for a fresh pixmap
+        m_pixmap.setDevicePixelRatio(1.0);
+    }
+
+    QPainter painter;
+    if (lastRow >= firstRow && painter.begin(&m_pixmap)) {
+        if (!fullUpdate) {
+            // clear the rows we will paint again
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.fillRect(0, firstRow, m_pixmap.width(), lastRow - firstRow + 1, Qt::transparent);
+            painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        }
+
+        paintMiniMapRows(painter, layout, firstRow, lastRow);
+
+        // end painting
+        painter.end();
+    }
+
+    // set right ratio
+    m_pixmap.setDevicePixelRatio(layout.devicePixelRatio);
+
+    // qCDebug(LOG_KTE) << time.elapsed();
+    // Redraw the scrollbar widget with the updated pixmap.
+    update();
+}
+
+void KateScrollBar::paintMiniMapRows(QPainter &painter, const MiniMapLayout &layout, int firstRow, int lastRow)
+{
+    const int docLineCount = layout.docLineCount;
+    const int lineIncrement = layout.lineIncrement;
+    const int charIncrement = layout.charIncrement;
 
     const QBrush backgroundColor = m_view->defaultStyleAttribute(KSyntaxHighlighting::Theme::TextStyle::Normal)->background();
     const QBrush defaultTextColor = m_view->defaultStyleAttribute(KSyntaxHighlighting::Theme::TextStyle::Normal)->foreground();
@@ -594,10 +712,6 @@ void KateScrollBar::updatePixmap()
     const QBrush modifiedLineBrush = modifiedLineColor;
     const QBrush savedLineBrush = savedLineColor;
 
-    // increase dimensions by ratio
-    m_pixmap = QPixmap(pixmapLineWidth * m_view->devicePixelRatioF(), pixmapLineCount * m_view->devicePixelRatioF());
-    m_pixmap.fill(QColor("transparent"));
-
     // The text currently selected in the document, to be drawn later.
     const KTextEditor::Range selection = m_view->selectionRange();
     const bool hasSelection = !selection.isEmpty();
@@ -607,153 +721,149 @@ void KateScrollBar::updatePixmap()
     // resusable buffer for line ranges;
     QList<Kate::TextRange *> decorations;
 
-    QPainter painter;
-    if (painter.begin(&m_pixmap)) {
-        // init pen once, afterwards, only change it if color changes to avoid a lot of allocation for setPen
-        painter.setPen(QPen(selectionBgColor, 1));
+    // init pen once, afterwards, only change it if color changes to avoid a lot of allocation for setPen
+    painter.setPen(QPen(selectionBgColor, 1));
 
-        // Do not force updates of the highlighting if the document is very large
-        const bool simpleMode = m_doc->lines() > 7500;
+    // Do not force updates of the highlighting if the document is very large
+    const bool simpleMode = m_doc->lines() > 7500;
 
-        int pixelY = 0;
-        int drawnLines = 0;
+    // every pixel row holds charIncrement drawn lines, every drawn line is every lineIncrement-th visible line
+    int drawnLines = firstRow * charIncrement;
+    int pixelY = firstRow;
 
-        // pen cache to avoid a lot of allocations from pen creation
-        QVarLengthArray<std::pair<QRgb, QPen>, 20> penCache;
+    // pen cache to avoid a lot of allocations from pen creation
+    QVarLengthArray<std::pair<QRgb, QPen>, 20> penCache;
 
-        // Iterate over all visible lines, drawing them.
-        for (int virtualLine = 0; virtualLine < docLineCount; virtualLine += lineIncrement) {
-            int realLineNumber = m_view->textFolding().visibleLineToLine(virtualLine);
-            const Kate::TextLine kateline = m_doc->plainKateTextLine(realLineNumber);
-            const QString lineText = kateline.text();
+    // Iterate over all visible lines of the rows, drawing them.
+    for (int virtualLine = drawnLines * lineIncrement; virtualLine < docLineCount && pixelY <= lastRow; virtualLine += lineIncrement) {
+        int realLineNumber = m_view->textFolding().visibleLineToLine(virtualLine);
+        const Kate::TextLine kateline = m_doc->plainKateTextLine(realLineNumber);
+        const QString lineText = kateline.text();
 
-            if (!simpleMode) {
-                m_doc->buffer().ensureHighlighted(realLineNumber);
-            }
+        if (!simpleMode) {
+            m_doc->buffer().ensureHighlighted(realLineNumber);
+        }
 
-            // get normal highlighting stuff
-            const auto &attributes = kateline.attributesList();
+        // get normal highlighting stuff
+        const auto &attributes = kateline.attributesList();
 
-            // get moving ranges with attribs (semantic highlighting and co.)
-            m_view->doc()->buffer().rangesForLine(realLineNumber, m_view, true, decorations);
+        // get moving ranges with attribs (semantic highlighting and co.)
+        m_view->doc()->buffer().rangesForLine(realLineNumber, m_view, true, decorations);
 
-            // Draw selection if it is on an empty line
+        // Draw selection if it is on an empty line
 
-            int pixelX = s_pixelMargin; // use this to control the offset of the text from the left
+        int pixelX = s_pixelMargin; // use this to control the offset of the text from the left
 
-            if (hasSelection) {
-                if (selection.contains(KTextEditor::Cursor(realLineNumber, 0)) && lineText.size() == 0) {
-                    if (selectionBgColor != painter.pen().brush()) {
-                        painter.setPen(QPen(selectionBgColor, 1));
-                    }
-                    painter.drawLine(s_pixelMargin, pixelY, s_pixelMargin + s_lineWidth - 1, pixelY);
+        if (hasSelection) {
+            if (selection.contains(KTextEditor::Cursor(realLineNumber, 0)) && lineText.size() == 0) {
+                if (selectionBgColor != painter.pen().brush()) {
+                    painter.setPen(QPen(selectionBgColor, 1));
                 }
-                // Iterate over the line to draw the background
-                int selStartX = -1;
-                int selEndX = -1;
-                for (int x = 0; (x < lineText.size() && x < s_lineWidth); x += charIncrement) {
-                    if (pixelX >= s_lineWidth + s_pixelMargin) {
-                        break;
-                    }
-                    // Query the selection and draw it behind the character
-                    if (selection.contains(KTextEditor::Cursor(realLineNumber, x))) {
-                        if (selStartX == -1) {
-                            selStartX = pixelX;
-                        }
-                        selEndX = pixelX;
-                        if (lineText.size() - 1 == x) {
-                            selEndX = s_lineWidth + s_pixelMargin - 1;
-                        }
+                painter.drawLine(s_pixelMargin, pixelY, s_pixelMargin + s_lineWidth - 1, pixelY);
+            }
+            // Iterate over the line to draw the background
+            int selStartX = -1;
+            int selEndX = -1;
+            for (int x = 0; (x < lineText.size() && x < s_lineWidth); x += charIncrement) {
+                if (pixelX >= s_lineWidth + s_pixelMargin) {
+                    break;
+                }
+                // Query the selection and draw it behind the character
+                if (selection.contains(KTextEditor::Cursor(realLineNumber, x))) {
+                    if (selStartX == -1) {
+                        selStartX = pixelX;
                     }
-
-                    if (lineText[x] == QLatin1Char('\t')) {
-                        pixelX += qMax(4 / charIncrement, 1); // FIXME: tab width...
-                    } else {
-                        pixelX++;
+                    selEndX = pixelX;
+                    if (lineText.size() - 1 == x) {
+                        selEndX = s_lineWidth + s_pixelMargin - 1;
                     }
                 }
 
-                if (selStartX != -1) {
-                    if (selectionBgColor != painter.pen().brush()) {
-                        painter.setPen(QPen(selectionBgColor, 1));
-                    }
-                    painter.drawLine(selStartX, pixelY, selEndX, pixelY);
+                if (lineText[x] == QLatin1Char('\t')) {
+                    pixelX += qMax(4 / charIncrement, 1); // FIXME: tab width...
+                } else {
+                    pixelX++;
                 }
             }
 
-            // Iterate over all the characters in the current line
-            getCharColorRanges(attributes, decorations, lineText, colorRangesForLine, penCache);
-            pixelX = s_pixelMargin;
-            for (int x = 0; (x < lineText.size() && x < s_lineWidth); x += charIncrement) {
-                if (pixelX >= s_lineWidth + s_pixelMargin) {
-                    break;
+            if (selStartX != -1) {
+                if (selectionBgColor != painter.pen().brush()) {
+                    painter.setPen(QPen(selectionBgColor, 1));
                 }
+                painter.drawLine(selStartX, pixelY, selEndX, pixelY);
+            }
+        }
 
-                // draw the pixels
-                if (lineText[x] == QLatin1Char(' ')) {
-                    pixelX++;
-                } else if (lineText[x] == QLatin1Char('\t')) {
-                    pixelX += qMax(4 / charIncrement, 1); // FIXME: tab width...
-                } else {
-                    const QPen *pen = nullptr;
-                    int rangeEnd = x + 1;
-                    for (const auto &cr : colorRangesForLine) {
-                        if (cr.startColumn <= x && x <= cr.endColumn) {
-                            rangeEnd = cr.endColumn;
-                            if (cr.penIndex != -1) {
-                                pen = &penCache[cr.penIndex].second;
-                            }
+        // Iterate over all the characters in the current line
+        getCharColorRanges(attributes, decorations, lineText, colorRangesForLine, penCache);
+        pixelX = s_pixelMargin;
+        for (int x = 0; (x < lineText.size() && x < s_lineWidth); x += charIncrement) {
+            if (pixelX >= s_lineWidth + s_pixelMargin) {
+                break;
+            }
+
+            // draw the pixels
+            if (lineText[x] == QLatin1Char(' ')) {
+                pixelX++;
+            } else if (lineText[x] == QLatin1Char('\t')) {
+                pixelX += qMax(4 / charIncrement, 1); // FIXME: tab width...
+            } else {
+                const QPen *pen = nullptr;
+                int rangeEnd = x + 1;
+                for (const auto &cr : colorRangesForLine) {
+                    if (cr.startColumn <= x && x <= cr.endColumn) {
+                        rangeEnd = cr.endColumn;
+                        if (cr.penIndex != -1) {
+                            pen = &penCache[cr.penIndex].second;
                         }
                     }
+                }
 
-                    if (!pen) {
-                        pen = &defaultTextPen;
-                    }
-                    // get the column range and color in which this 'x' lies
-                    painter.setPen(*pen);
+                if (!pen) {
+                    pen = &defaultTextPen;
+                }
+                // get the column range and color in which this 'x' lies
+                painter.setPen(*pen);
 
-                    // Actually draw the pixels with the color queried from the renderer.
-                    QVarLengthArray<QPoint, 100> points;
-                    for (; x < rangeEnd; x += charIncrement) {
-                        if (pixelX >= s_lineWidth + s_pixelMargin) {
-                            break;
-                        }
-                        points.append({pixelX++, pixelY});
+                // Actually draw the pixels with the color queried from the renderer.
+                QVarLengthArray<QPoint, 100> points;
+                for (; x < rangeEnd; x += charIncrement) {
+                    if (pixelX >= s_lineWidth + s_pixelMargin) {
+                        break;
                     }
-                    painter.drawPoints(points.data(), points.size());
+                    points.append({pixelX++, pixelY});
                 }
-            }
-            drawnLines++;
-            if (((drawnLines) % charIncrement) == 0) {
-                pixelY++;
+                painter.drawPoints(points.data(), points.size());
             }
         }
-        // qCDebug(LOG_KTE) << drawnLines;
-        // Draw line modification marker map.
-        // Disable this if the document is really huge,
-        // since it requires querying every line.
-        if (m_doc->lines() < 50000) {
-            for (int lineno = 0; lineno < docLineCount; lineno++) {
-                int realLineNo = m_view->textFolding().visibleLineToLine(lineno);
-                const auto line = m_doc->plainKateTextLine(realLineNo);
-                const QBrush &col = line.markedAsModified() ? modifiedLineBrush : savedLineBrush;
-                if (line.markedAsModified() || line.markedAsSavedOnDisk()) {
-                    int pos = (lineno * pixmapLineCount) / pixmapLinesUnscaled;
-                    painter.fillRect(2, pos, 3, 1, col);
-                }
+        drawnLines++;
+        if (((drawnLines) % charIncrement) == 0) {
+            pixelY++;
+        }
+    }
+    // qCDebug(LOG_KTE) << drawnLines;
+    // Draw line modification marker map.
+    // Disable this if the document is really huge,
+    // since it requires querying every line.
+    if (m_doc->lines() < 50000) {
+        // first line whose marker may end up in the first row
+        const int firstMarkerLine = (qint64(firstRow) * layout.pixmapLinesUnscaled) / layout.pixmapLineCount;
+        for (int lineno = firstMarkerLine; lineno < docLineCount; lineno++) {
+            int pos = (lineno * layout.pixmapLineCount) / layout.pixmapLinesUnscaled;
+            if (pos < firstRow) {
+                continue;
+            }
+            if (pos > lastRow) {
+                break;
+            }
+            int realLineNo = m_view->textFolding().visibleLineToLine(lineno);
+            const auto line = m_doc->plainKateTextLine(realLineNo);
+            const QBrush &col = line.markedAsModified() ? modifiedLineBrush : savedLineBrush;
+            if (line.markedAsModified() || line.markedAsSavedOnDisk()) {
+                painter.fillRect(2, pos, 3, 1, col);
             }
         }
-
-        // end painting
-        painter.end();
     }
-
-    // set right ratio
-    m_pixmap.setDevicePixelRatio(m_view->devicePixelRatioF());
-
-    // qCDebug(LOG_KTE) << time.elapsed();
-    // Redraw the scrollbar widget with the updated pixmap.
-    update();
 }
 
 void KateScrollBar::miniMapPaintEvent(QPaintEvent *e)
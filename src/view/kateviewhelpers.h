@@ -26,7 +26,10 @@
 
 #include "katetextline.h"
 #include <ktexteditor/cursor.h>
+#include <ktexteditor/linerange.h>
 #include <ktexteditor/message.h>
+#include <ktexteditor/range.h>
+#include <ktexteditor_export.h>
 
 namespace KTextEditor
 {
@@ -52,6 +55,7 @@ namespace Kate
 class TextRange;
 }
 
+class QPainter;
 class QTimer;
 class QVBoxLayout;
 class QStackedWidget;
@@ -105,6 +109,7 @@ private:
 class KateScrollBar : public QScrollBar
 {
     Q_OBJECT
+    friend class KateViewTest;
 
 public:
     KateScrollBar(Qt::Orientation orientation, class KateViewInternal *parent);
@@ -151,11 +156,21 @@ public:
         update();
     }
 
+    /**
+     * Queue a rebuild of the complete minimap pixmap.
+     */
     inline void queuePixmapUpdate()
     {
+        m_needsFullPixmapUpdate = true;
         m_updateTimer.start();
     }
 
+    /**
+     * Queue a repaint of the minimap rows covering the given document lines.
+     * @param lineRange changed lines, in document line numbers
+     */
+    void queuePixmapUpdate(KTextEditor::LineRange lineRange);
+
 Q_SIGNALS:
     void sliderMMBMoved(int value);
 
@@ -174,7 +189,7 @@ protected Q_SLOTS:
     void marksChanged();
 
 public Q_SLOTS:
-    void updatePixmap();
+    KTEXTEDITOR_EXPORT void updatePixmap();
 
 private Q_SLOTS:
     void showTextPreview();
@@ -191,6 +206,24 @@ private:
 
     int minimapYToStdY(int y);
 
+    /**
+     * Geometry of the minimap pixmap, if it did not change since the last update,
+     * only the rows covering changed lines need to be repainted.
+     */
+    struct MiniMapLayout {
+        int docLineCount = 0;
+        int pixmapLineCount = 0;
+        int pixmapLinesUnscaled = 0;
+        int pixmapLineWidth = 0;
+        int lineIncrement = 1;
+        int charIncrement = 1;
+        qreal devicePixelRatio = 1.0;
+        bool operator==(const MiniMapLayout &) const = default;
+    };
+    MiniMapLayout computeMiniMapLayout();
+    void paintMiniMapRows(QPainter &painter, const MiniMapLayout &layout, int firstRow, int lastRow);
+    void markSelectionDirty(KTextEditor::Range oldSelection, KTextEditor::Range newSelection);
+
     struct ColumnRangeWithColor {
         int penIndex = -1;
         int startColumn;
@@ -220,6 +253,11 @@ private:
     int m_miniMapWidth;
 
     QPixmap m_pixmap;
+    MiniMapLayout m_pixmapLayout;
+    KTextEditor::Range m_pixmapSelection = KTextEditor::Range::invalid();
+    // document lines changed since the last pixmap update
+    KTextEditor::LineRange m_dirtyLines = KTextEditor::LineRange::invalid();
+    bool m_needsFullPixmapUpdate = true;
     int m_grooveHeight;
     QRect m_stdGroveRect;
     QRect m_mapGroveRect;
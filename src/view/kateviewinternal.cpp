@@ -2795,10 +2795,10 @@ void KateViewInternal::updateCursor(const KTextEditor::Cursor newCursor, bool fo
 
     updateFoldingMarkersHighlighting();
 
-    // avoid double work, tagLine => tagLines => not that cheap, much more costly than to compare 2 ints
-    tagLine(oldDisplayCursor);
+    // only the caret and the current line background changed, the layout of the lines is still valid
+    tagLinesForRepaint(oldDisplayCursor, oldDisplayCursor);
     if (oldDisplayCursor.line() != m_displayCursor.line()) {
-        tagLine(m_displayCursor);
+        tagLinesForRepaint(m_displayCursor, m_displayCursor);
     }
 
     updateMicroFocus();
@@ -3000,6 +3000,28 @@ bool KateViewInternal::tagRange(KTextEditor::Range range, bool realCursors)
     return tagLines(range.start(), range.end(), realCursors);
 }
 
+bool KateViewInternal::tagLinesForRepaint(KTextEditor::Cursor start, KTextEditor::Cursor end)
+{
+    if (end.line() < startLine() || start.line() > startLine() + cache()->viewCacheLineCount()) {
+        return false;
+    }
+
+    cache()->updateViewCache(startPos());
+
+    bool ret = false;
+    for (int z = 0; z < cache()->viewCacheLineCount(); z++) {
+        KateTextLayout &line = cache()->viewLine(z);
+        if (line.isValid()
+            && (line.virtualLine() > start.line() || (line.virtualLine() == start.line() && line.endCol() >= start.column() && start.column() != -1))
+            && (line.virtualLine() < end.line() || (line.virtualLine() == end.line() && (line.startCol() <= end.column() || end.column() == -1)))) {
+            line.setDirty(true);
+            ret = true;
+        }
+    }
+
+    return ret;
+}
+
 void KateViewInternal::tagAll()
 {
     // clear the cache...
@@ -3007,28 +3029,64 @@ void KateViewInternal::tagAll()
 
     m_leftBorder->updateFont();
     m_leftBorder->update();
+
+    m_lineScroll->queuePixmapUpdate();
 }
 
 void KateViewInternal::paintCursor()
 {
-    QVarLengthArray<int, 64> updatedLines;
-    if (tagLine(m_displayCursor)) {
-        updatedLines.push_back(m_displayCursor.line());
-    }
+    // only the carets change, no need to relayout or repaint the complete lines
+    QRegion caretRegion;
+    bool linesTagged = false;
+    auto addCaret = [&](const KTextEditor::Cursor c) {
+        if (c.column() > doc()->lineLength(c.line())) {
+            // caret behind the end of line, fallback to repaint the line
+            linesTagged |= tagLinesForRepaint(toVirtualCursor(c), toVirtualCursor(c));
+            return;
+        }
+        caretRegion += caretRect(c);
+    };
+
+    addCaret(m_cursor);
 
     const int s = view()->firstDisplayedLine();
     const int e = view()->lastDisplayedLine();
     for (const auto &c : view()->m_secondaryCursors) {
         auto p = c.cursor();
-        if (p.line() >= s - 1 && p.line() <= e + 1 && !updatedLines.contains(p.line())) {
-            updatedLines.push_back(p.line());
-            tagLines(p, p, true);
+        if (p.line() >= s - 1 && p.line() <= e + 1) {
+            addCaret(p);
         }
     }
 
-    if (!updatedLines.isEmpty()) {
-        updateDirty(); // paintText (0,0,width(), height(), true);
+    if (linesTagged) {
+        updateDirty();
+    }
+
+    if (!caretRegion.isEmpty()) {
+        update(caretRegion);
+    }
+}
+
+QRect KateViewInternal::caretRect(const KTextEditor::Cursor cursor) const
+{
+    const QPoint pos = cursorToCoordinate(cursor, true, false);
+    if (pos.y() < 0) {
+        return QRect();
     }
+
+    // block and half carets span the complete character, which might be wider than a space, e.g. a tab
+    int left = pos.x();
+    int right = pos.x() + int(renderer()->spaceWidth()) + 1;
+    if (cursor.column() < doc()->lineLength(cursor.line())) {
+        const QPoint next = cursorToCoordinate(KTextEditor::Cursor(cursor.line(), cursor.column() + 1), true, false);
+        if (next.y() == pos.y()) {
+            left = qMin(left, next.x());
+            right = qMax(right, next.x());
+        }
+    }
+
+    // a bit of extra space for the line caret width and antialiasing
+    return QRect(left - 2, pos.y(), right - left + 4, renderer()->lineHeight());
 }
 
 KTextEditor::Cursor KateViewInternal::cursorForPoint(QPoint p)
@@ -4617,6 +4675,13 @@ void KateViewInternal::editEnd(int editTagLineStart, int editTagLineEnd, bool ta
         tagLines(editTagLineStart, tagFrom ? qMax(doc()->lastLine() + 1, editTagLineEnd) : editTagLineEnd, true);
     }
 
+    // the minimap only needs to repaint the changed lines, unless lines got inserted or removed
+    if (tagFrom) {
+        m_lineScroll->queuePixmapUpdate();
+    } else if (editTagLineStart >= 0 && editTagLineEnd >= 0) {
+        m_lineScroll->queuePixmapUpdate(KTextEditor::LineRange(editTagLineStart, editTagLineEnd));
+    }
+
     if (editOldCursor == m_cursor.toCursor()) {
         updateBracketMarks();
     }
@@ -115,6 +115,13 @@ public:
 
     bool tagRange(KTextEditor::Range range, bool realCursors);
 
+    /**
+     * Mark the view lines between the given virtual cursors for repaint, without
+     * relayouting them. Sufficient if only cursor related painting changed,
+     * e.g. the current line background.
+     */
+    bool tagLinesForRepaint(KTextEditor::Cursor start, KTextEditor::Cursor end);
+
     void tagAll();
 
     void updateDirty();
@@ -156,7 +163,11 @@ public Q_SLOTS:
     void slotDecFontSizes(qreal step = 1.0);
     void slotResetFontSizes();
 
-    void paintCursor();
+    /**
+     * Repaint the carets of all cursors, e.g. for blinking.
+     * Only the caret rectangles are updated, the lines are not relayouted.
+     */
+    KTEXTEDITOR_EXPORT void paintCursor();
 
 private Q_SLOTS:
     void scrollLines(int line); // connected to the sliderMoved of the m_lineScroll
@@ -218,6 +229,12 @@ public:
     }
 
     QPoint cursorToCoordinate(const KTextEditor::Cursor cursor, bool realCursor = true, bool includeBorder = true) const;
+
+    /**
+     * Area covered by the caret at the given real cursor, in widget coordinates.
+     * Returns an empty rect if the cursor is not visible.
+     */
+    KTEXTEDITOR_EXPORT QRect caretRect(const KTextEditor::Cursor cursor) const;
     // by default, works on coordinates of the whole widget, eg. offsetted by the border
     KTextEditor::Cursor coordinatesToCursor(const QPoint &coord, bool includeBorder = true) const;
     QPoint cursorCoordinates(bool includeBorder = true) const;
@@ -5,91 +5,237 @@
 */
 
 #include "wordcounter.h"
+#include "katebuffer.h"
 #include "katedocument.h"
 #include "kateview.h"
 
+#include <QThread>
+
+#include <array>
+#include <utility>
+
+/**
+ * Count in a thread if that many blocks are not counted yet.
+ */
+static constexpr int BackgroundBlockCount = 1000;
+
 WordCounter::WordCounter(KTextEditor::ViewPrivate *view)
     : QObject(view)
+    , m_view(view)
     , m_wordsInDocument(0)
     , m_wordsInSelection(0)
     , m_charsInDocument(0)
     , m_charsInSelection(0)
-    , m_startRecalculationFrom(0)
-    , m_document(view->document())
 {
-    connect(view->doc(), &KTextEditor::DocumentPrivate::textInsertedRange, this, &WordCounter::textInserted);
-    connect(view->doc(), &KTextEditor::DocumentPrivate::textRemoved, this, &WordCounter::textRemoved);
+    connect(view->doc(), &KTextEditor::DocumentPrivate::textInsertedRange, this, &WordCounter::textChanged);
+    connect(view->doc(), &KTextEditor::DocumentPrivate::textRemoved, this, &WordCounter::textChanged);
     connect(view->doc(), &KTextEditor::DocumentPrivate::loaded, this, &WordCounter::recalculate);
     connect(view, &KTextEditor::View::selectionChanged, this, &WordCounter::selectionChanged);
 
     m_timer.setInterval(500);
     m_timer.setSingleShot(true);
-    connect(&m_timer, &QTimer::timeout, this, &WordCounter::recalculateLines);
+    connect(&m_timer, &QTimer::timeout, this, &WordCounter::recalculateBlocks);
 
-    recalculate(m_document);
+    recalculate(view->document());
 }
 
-void WordCounter::textInserted(KTextEditor::Document *, KTextEditor::Range range)
+WordCounter::~WordCounter()
 {
-    auto startLine = m_countByLine.begin() + range.start().line();
-    auto endLine = m_countByLine.begin() + range.end().line();
-    size_t newLines = std::distance(startLine, endLine);
+    if (m_thread) {
+        m_cancel = true;
+        m_thread->wait();
+        delete m_thread;
+    }
+}
 
-    if (m_countByLine.empty()) { // was empty document before insert
-        newLines++;
+void WordCounter::textChanged()
+{
+    m_timer.start();
+}
+
+void WordCounter::recalculate(KTextEditor::Document *)
+{
+    // new content, all blocks are new, too
+    recalculateBlocks();
+}
+
+int WordCounter::countWords(QStringView text)
+{
+    // ASCII is looked up in a table, only other characters need the Unicode properties
+    static constexpr auto asciiWordChar = [] {
+        std::array<bool, 128> table = {};
+        for (int c = '0'; c <= '9'; ++c) {
+            table[c] = true;
+        }
+        for (int c = 'a'; c <= 'z'; ++c) {
+            table[c] = true;
+            table[c - 'a' + 'A'] = true;
+        }
+        return table;
+    }();
+
+    int count = 0;
+    bool inWord = false;
+    for (const QChar c : text) {
+        const bool wordChar = c.unicode() < 128 ? asciiWordChar[c.unicode()] : c.isLetterOrNumber();
+        count += wordChar && !inWord;
+        inWord = wordChar;
     }
+    return count;
+}
 
-    if (newLines > 0) {
-        m_countByLine.insert(startLine, newLines, -1);
+/**
+ * Do both snapshots consist of the same blocks?
+ * The revision alone is not enough, it starts again at 0 on reload.
+ */
+static bool sameBlocks(const Kate::TextSnapshot &a, const Kate::TextSnapshot &b)
+{
+    if (a.revision() != b.revision() || a.blocks().size() != b.blocks().size()) {
+        return false;
+    }
+    for (qsizetype i = 0; i < a.blocks().size(); ++i) {
+        if (a.blocks()[i].constData() != b.blocks()[i].constData()) {
+            return false;
+        }
     }
+    return true;
+}
 
-    m_countByLine[range.end().line()] = -1;
-    m_timer.start();
+WordCounter::BlockCounts WordCounter::countBlocks(const Kate::TextSnapshot &snapshot, const BlockCounts &known, const std::atomic<bool> &cancel)
+{
+    BlockCounts counts;
+    counts.reserve(snapshot.blocks().size());
+    for (const auto &block : snapshot.blocks()) {
+        if (cancel) {
+            return counts;
+        }
+
+        const auto it = known.constFind(block.constData());
+        if (it != known.cend()) {
+            counts.insert(block.constData(), *it);
+            continue;
+        }
+
+        Count count;
+        for (const Kate::TextLine &line : block) {
+            count.words += countWords(line.text());
+            count.chars += line.length();
+        }
+        counts.insert(block.constData(), count);
+    }
+    return counts;
 }
 
-void WordCounter::textRemoved(KTextEditor::Document *, KTextEditor::Range range, const QString &)
+void WordCounter::recalculateBlocks()
 {
-    const auto startLine = m_countByLine.begin() + range.start().line();
-    const auto endLine = m_countByLine.begin() + range.end().line();
-    const int removedLines = endLine - startLine;
+    if (m_thread) {
+        m_pendingUpdate = true;
+        return;
+    }
+
+    const Kate::TextSnapshot snapshot = m_view->doc()->buffer().snapshot();
+    if (sameBlocks(snapshot, m_snapshot)) {
+        return;
+    }
+
+    int uncounted = 0;
+    for (const auto &block : snapshot.blocks()) {
+        uncounted += !m_blockCounts.contains(block.constData());
+    }
+
+    if (uncounted < BackgroundBlockCount) {
+        applyCounts(snapshot, countBlocks(snapshot, m_blockCounts, m_cancel));
+        return;
+    }
+
+    // the snapshot stays valid while the user keeps editing
+    m_thread = QThread::create([this, snapshot, known = m_blockCounts] {
+        m_result = countBlocks(snapshot, known, m_cancel);
+        m_resultSnapshot = snapshot;
+        if (!m_cancel) {
+            QMetaObject::invokeMethod(this, &WordCounter::countingDone, Qt::QueuedConnection);
+        }
+    });
+    m_thread->start(QThread::LowPriority);
+}
 
-    if (removedLines > 0) {
-        m_countByLine.erase(startLine, endLine);
+void WordCounter::countingDone()
+{
+    // already picked up by updateNow()
+    if (!m_thread) {
+        return;
     }
 
-    if (!m_countByLine.empty()) {
-        m_countByLine[range.start().line()] = -1;
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    applyCounts(std::exchange(m_resultSnapshot, {}), std::exchange(m_result, {}));
+
+    // edits during the count, most blocks are known now
+    if (m_pendingUpdate) {
+        m_pendingUpdate = false;
         m_timer.start();
-    } else {
-        Q_EMIT changed(0, 0, 0, 0);
     }
 }
 
-void WordCounter::recalculate(KTextEditor::Document *)
+void WordCounter::updateNow()
 {
-    m_countByLine = std::vector<int>(m_document->lines(), -1);
-    m_timer.start();
+    m_timer.stop();
+    if (m_thread) {
+        m_thread->wait();
+        countingDone();
+        m_timer.stop();
+    }
+    recalculateBlocks();
+    if (m_thread) {
+        m_thread->wait();
+        countingDone();
+        m_timer.stop();
+    }
 }
 
-static int countWords(const QString &text)
+void WordCounter::applyCounts(const Kate::TextSnapshot &snapshot, BlockCounts &&counts)
 {
-    int count = 0;
-    bool inWord = false;
+    m_snapshot = snapshot;
+    m_blockCounts = std::move(counts);
 
-    for (const QChar c : text) {
-        if (c.isLetterOrNumber()) {
-            if (!inWord) {
-                inWord = true;
-            }
-        } else {
-            if (inWord) {
-                inWord = false;
-                count++;
+    m_wordsInDocument = m_charsInDocument = 0;
+    for (const Count &count : std::as_const(m_blockCounts)) {
+        m_wordsInDocument += count.words;
+        m_charsInDocument += count.chars;
+    }
+
+    Q_EMIT changed(m_wordsInDocument, m_wordsInSelection, m_charsInDocument, m_charsInSelection);
+}
+
+WordCounter::Count WordCounter::countLines(int begin, int end) const
+{
+    Count result;
+
+    // whole blocks from the counts, as long as they didn't change since the last count, the rest line by line
+    // m_snapshot keeps the counted blocks alive, a changed block can't have the address of a counted one
+    const Kate::TextSnapshot snapshot = m_view->doc()->buffer().snapshot();
+    int blockStart = 0;
+    for (const auto &block : snapshot.blocks()) {
+        const int blockEnd = blockStart + block.size();
+        if (blockStart >= end) {
+            break;
+        }
+        const auto known = m_blockCounts.constFind(block.constData());
+        if (blockStart >= begin && blockEnd <= end && known != m_blockCounts.cend()) {
+            result.words += known->words;
+            result.chars += known->chars;
+        } else if (blockEnd > begin) {
+            for (int line = std::max(begin, blockStart); line < std::min(end, blockEnd); ++line) {
+                const Kate::TextLine &textLine = block[line - blockStart];
+                result.words += countWords(textLine.text());
+                result.chars += textLine.length();
             }
         }
+        blockStart = blockEnd;
     }
-
-    return inWord ? count + 1 : count;
+    return result;
 }
 
 void WordCounter::selectionChanged(KTextEditor::View *view)
@@ -116,10 +262,9 @@ void WordCounter::selectionChanged(KTextEditor::View *view)
         m_charsInSelection += firstLineText.size();
 
         // whole lines
-        for (int i = firstLine + 1; i < lastLine; i++) {
-            m_wordsInSelection += m_countByLine[i];
-            m_charsInSelection += m_document->lineLength(i);
-        }
+        const Count lines = countLines(firstLine + 1, lastLine);
+        m_wordsInSelection += lines.words;
+        m_charsInSelection += lines.chars;
 
         const KTextEditor::Range lastLineRange(KTextEditor::Cursor(lastLine, 0), view->selectionRange().end());
         const QString lastLineText = view->document()->text(lastLineRange);
@@ -130,44 +275,4 @@ void WordCounter::selectionChanged(KTextEditor::View *view)
     Q_EMIT changed(m_wordsInDocument, m_wordsInSelection, m_charsInDocument, m_charsInSelection);
 }
 
-void WordCounter::recalculateLines()
-{
-    if ((size_t)m_startRecalculationFrom >= m_countByLine.size()) {
-        m_startRecalculationFrom = 0;
-    }
-
-    int wordsCount = 0;
-    int charsCount = 0;
-    int calculated = 0;
-    size_t i = m_startRecalculationFrom;
-    constexpr int MaximumLinesToRecalculate = 100;
-
-    // stay in bounds, vector might be empty, even 0 is too large then
-    while (i < m_countByLine.size()) {
-        if (m_countByLine[i] == -1) {
-            m_countByLine[i] = countWords(m_document->line(i));
-            if (++calculated > MaximumLinesToRecalculate) {
-                m_startRecalculationFrom = i;
-                m_timer.start();
-                return;
-            }
-        }
-
-        wordsCount += m_countByLine[i];
-        charsCount += m_document->lineLength(i);
-
-        if (++i == m_countByLine.size()) { // array cycle
-            i = 0;
-        }
-
-        if (i == (size_t)m_startRecalculationFrom) {
-            break;
-        }
-    }
-
-    m_wordsInDocument = wordsCount;
-    m_charsInDocument = charsCount;
-    Q_EMIT changed(m_wordsInDocument, m_wordsInSelection, m_charsInDocument, m_charsInSelection);
-}
-
 #include "moc_wordcounter.cpp"
@@ -7,10 +7,16 @@
 #ifndef WORDCOUNTER_H
 #define WORDCOUNTER_H
 
+#include "katetextsnapshot.h"
+
+#include <QHash>
 #include <QObject>
 #include <QString>
 #include <QTimer>
-#include <vector>
+
+#include <ktexteditor_export.h>
+
+#include <atomic>
 
 namespace KTextEditor
 {
@@ -20,30 +26,88 @@ class ViewPrivate;
 class Range;
 }
 
-class WordCounter : public QObject
+class QThread;
+
+/**
+ * Word and character counts of the document and the selection for the status bar.
+ *
+ * The counts are kept per buffer block. Blocks unchanged since the last count still
+ * share their lines with the remembered snapshot and keep their counts, only changed
+ * blocks are counted again. The first count of a large document runs in a thread.
+ */
+class KTEXTEDITOR_EXPORT WordCounter : public QObject
 {
     Q_OBJECT
 
 public:
     explicit WordCounter(KTextEditor::ViewPrivate *view);
+    ~WordCounter() override;
+
+    /**
+     * Number of words in @p text, words are runs of letters and numbers.
+     */
+    static int countWords(QStringView text);
+
+    /**
+     * Count the changed blocks right away instead of waiting for the timer.
+     * If a thread is counting, this waits for it.
+     */
+    void updateNow();
 
 Q_SIGNALS:
     void changed(int wordsInDocument, int wordsInSelection, int charsInDocument, int charsInSelection);
 
 private Q_SLOTS:
-    void textInserted(KTextEditor::Document *document, KTextEditor::Range range);
-    void textRemoved(KTextEditor::Document *document, KTextEditor::Range range, const QString &oldText);
+    void textChanged();
     void recalculate(KTextEditor::Document *document);
     void selectionChanged(KTextEditor::View *view);
-    void recalculateLines();
+    void recalculateBlocks();
+
+private:
+    struct Count {
+        int words = 0;
+        int chars = 0;
+    };
+
+    /**
+     * block lines => counts of the block
+     */
+    typedef QHash<const Kate::TextLine *, Count> BlockCounts;
+
+    /**
+     * Counts for all blocks of @p snapshot, the ones in @p known are taken from there.
+     * Returns early if @p cancel gets set.
+     */
+    static BlockCounts countBlocks(const Kate::TextSnapshot &snapshot, const BlockCounts &known, const std::atomic<bool> &cancel);
+
+    void applyCounts(const Kate::TextSnapshot &snapshot, BlockCounts &&counts);
+    void countingDone();
+
+    /**
+     * Counts of the lines [begin, end), only lines of blocks changed since the last count are counted.
+     */
+    Count countLines(int begin, int end) const;
 
 private:
-    std::vector<int> m_countByLine;
+    KTextEditor::ViewPrivate *const m_view;
     int m_wordsInDocument, m_wordsInSelection;
     int m_charsInDocument, m_charsInSelection;
     QTimer m_timer;
-    int m_startRecalculationFrom;
-    KTextEditor::Document *m_document;
+
+    /**
+     * Buffer state the counts belong to, keeps the counted blocks alive.
+     */
+    Kate::TextSnapshot m_snapshot;
+    BlockCounts m_blockCounts;
+
+    /**
+     * Thread counting many blocks, the result is passed back through m_result.
+     */
+    QThread *m_thread = nullptr;
+    std::atomic<bool> m_cancel = false;
+    Kate::TextSnapshot m_resultSnapshot;
+    BlockCounts m_result;
+    bool m_pendingUpdate = false;
 };
 
 #endif